@@ -82,8 +82,12 @@ public:
         if (numChannels == 0)
             return;
         
-        // Calculate number of LEDs (3 bytes per LED)
-        int numLEDs = numChannels / 3;
+        // Adalight has no universes - suppress byte-identical frames as a whole
+        if (!shouldSendSlot(0, 0, dmxData, numChannels))
+            return;
+        
+        // Calculate number of LEDs (3 bytes per LED, 4 for RGBW)
+        int numLEDs = numChannels / channelsPerPixel;
         
         // Build complete packet: 6 byte header + RGB data
         // Use pre-allocated buffer to avoid heap allocation on audio thread
@@ -182,8 +186,8 @@ private:
     juce::String currentSerialPort;
     int currentBaudRate = 115200;  // Default baud rate for WLED Adalight
     
-    // Pre-allocated packet buffer: 6-byte header + max 512 LEDs * 3 bytes = 1542 bytes
-    static constexpr int MAX_PACKET_SIZE = 6 + 512 * 3;
+    // Pre-allocated packet buffer: 6-byte header + max 512 LEDs * 4 bytes (RGBW) = 2054 bytes
+    static constexpr int MAX_PACKET_SIZE = 6 + 512 * 4;
     uint8_t packetBuffer[MAX_PACKET_SIZE] = {0};
     // Other errors
     
@@ -335,6 +339,9 @@ private:
     
     void closeSerialPort()
     {
+        // The device loses its frame on reconnect - send the next one in full
+        invalidateSentFrames();
+        
         if (isConnected())
         {
             DBG("AdalightSender::closeSerialPort - closing port: '" + currentSerialPort + "'");
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    AmbientRenderer.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Idle animation shown while no notes are playing
+enum class AmbientMode
+{
+    Off = 0,
+    Breathing,  // The whole strip slowly pulses in the base colour
+    Gradient,   // A hue gradient around the base colour drifting along the strip
+    Noise       // Smooth, slowly changing brightness noise in the base colour
+};
+
+struct AmbientSettings
+{
+    AmbientMode mode = AmbientMode::Off;
+    float brightness = 0.25f;  // Peak level of the animation
+    float speed = 0.1f;        // Animation cycles per second
+    float hue = 0.667f;        // Base colour
+    float saturation = 1.0f;
+    float masterBrightness = 1.0f;  // Applied by the compositor; at 0 every frame would be black
+
+    bool isEnabled() const { return mode != AmbientMode::Off && brightness > 0.0f && masterBrightness > 0.0f; }
+
+    bool operator== (const AmbientSettings& other) const
+    {
+        return mode == other.mode && brightness == other.brightness && speed == other.speed
+            && hue == other.hue && saturation == other.saturation && masterBrightness == other.masterBrightness;
+    }
+};
+
+// Renders the ambient animation as 16-bit fixed-point RGB, the same format the LayerStack
+// produces, so it can go through a FrameCompositor like any other frame.
+// Runs on the output thread only - it never touches the audio thread's layers.
+class AmbientRenderer
+{
+public:
+    // Fill [firstPixel, firstPixel + numPixels) of rgbFrame, other pixels are left untouched
+    void render(uint16_t* rgbFrame, int firstPixel, int numPixels, double timeSeconds, const AmbientSettings& settings)
+    {
+        if (!settings.isEnabled() || numPixels <= 0)
+            return;
+
+        const float phase = static_cast<float>(std::fmod(timeSeconds * settings.speed, 1.0));
+        const float twoPi = juce::MathConstants<float>::twoPi;
+        uint16_t* dest = rgbFrame + firstPixel * 3;
+
+        switch (settings.mode)
+        {
+            case AmbientMode::Breathing:
+            {
+                // Never quite dark, so the strip visibly stays "on"
+                const float level = settings.brightness * (0.1f + 0.9f * (0.5f - 0.5f * std::cos(twoPi * phase)));
+                float rgb[3];
+                hsvToRgb(settings.hue, settings.saturation, level, rgb);
+
+                for (int pixel = 0; pixel < numPixels; pixel++)
+                    writePixel(dest + pixel * 3, rgb);
+                break;
+            }
+
+            case AmbientMode::Gradient:
+            {
+                // One full sine of hue offset (+-0.08) across the strip, scrolling with time
+                for (int pixel = 0; pixel < numPixels; pixel++)
+                {
+                    const float position = static_cast<float>(pixel) / static_cast<float>(numPixels);
+                    float hue = settings.hue + 0.08f * std::sin(twoPi * (position - phase));
+                    hue -= std::floor(hue);
+
+                    float rgb[3];
+                    hsvToRgb(hue, settings.saturation, settings.brightness, rgb);
+                    writePixel(dest + pixel * 3, rgb);
+                }
+                break;
+            }
+
+            case AmbientMode::Noise:
+            {
+                // Value noise over (LED, time): features are about NOISE_SCALE LEDs wide
+                // and change once per animation cycle
+                const float time = static_cast<float>(timeSeconds * settings.speed);
+                float base[3];
+                hsvToRgb(settings.hue, settings.saturation, settings.brightness, base);
+
+                for (int pixel = 0; pixel < numPixels; pixel++)
+                {
+                    const float level = valueNoise(static_cast<float>(pixel) / NOISE_SCALE, time);
+                    const float rgb[3] = { base[0] * level, base[1] * level, base[2] * level };
+                    writePixel(dest + pixel * 3, rgb);
+                }
+                break;
+            }
+
+            case AmbientMode::Off:
+            default:
+                break;
+        }
+    }
+
+private:
+    static constexpr float NOISE_SCALE = 8.0f;
+
+    static void writePixel(uint16_t* dest, const float* rgb)
+    {
+        for (int channel = 0; channel < 3; channel++)
+            dest[channel] = static_cast<uint16_t>(juce::jlimit(0.0f, 1.0f, rgb[channel]) * 65535.0f + 0.5f);
+    }
+
+    // Float HSV -> RGB (juce::Colour would round every pixel to 8 bits before the output LUTs)
+    static void hsvToRgb(float hue, float saturation, float value, float* rgb)
+    {
+        const float h = (hue - std::floor(hue)) * 6.0f;
+        const int sector = static_cast<int>(h) % 6;
+        const float f = h - std::floor(h);
+        const float p = value * (1.0f - saturation);
+        const float q = value * (1.0f - saturation * f);
+        const float t = value * (1.0f - saturation * (1.0f - f));
+
+        switch (sector)
+        {
+            case 0:  rgb[0] = value; rgb[1] = t;     rgb[2] = p;     break;
+            case 1:  rgb[0] = q;     rgb[1] = value; rgb[2] = p;     break;
+            case 2:  rgb[0] = p;     rgb[1] = value; rgb[2] = t;     break;
+            case 3:  rgb[0] = p;     rgb[1] = q;     rgb[2] = value; break;
+            case 4:  rgb[0] = t;     rgb[1] = p;     rgb[2] = value; break;
+            default: rgb[0] = value; rgb[1] = p;     rgb[2] = q;     break;
+        }
+    }
+
+    // Smoothly interpolated lattice noise in 0..1
+    static float valueNoise(float x, float y)
+    {
+        const float xFloor = std::floor(x);
+        const float yFloor = std::floor(y);
+        const int xi = static_cast<int>(xFloor);
+        const int yi = static_cast<int>(yFloor);
+        const float xf = smoothStep(x - xFloor);
+        const float yf = smoothStep(y - yFloor);
+
+        const float top = juce::jmap(xf, lattice(xi, yi), lattice(xi + 1, yi));
+        const float bottom = juce::jmap(xf, lattice(xi, yi + 1), lattice(xi + 1, yi + 1));
+        return juce::jmap(yf, top, bottom);
+    }
+
+    static float smoothStep(float t) { return t * t * (3.0f - 2.0f * t); }
+
+    static float lattice(int x, int y)
+    {
+        juce::uint32 hash = static_cast<juce::uint32>(x) * 0x8da6b343u ^ static_cast<juce::uint32>(y) * 0xd8163841u;
+        hash ^= hash >> 13;
+        hash *= 0x5bd1e995u;
+        hash ^= hash >> 15;
+        return static_cast<float>(hash & 0xffff) / 65535.0f;
+    }
+};
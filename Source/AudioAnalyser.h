@@ -0,0 +1,305 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+// What the audio-reactive layer shows
+enum class AudioReactiveMode
+{
+    Off = 0,
+    Spectrum,   // Log-spaced bands across the strip
+    Flash,      // The whole strip flashes on onsets
+    Both
+};
+
+// One analysis result: band levels and onset flash, all 0..1
+struct AudioAnalysisFrame
+{
+    static constexpr int NUM_BANDS = 32;
+
+    float bands[NUM_BANDS] = {};
+    float onset = 0.0f;
+};
+
+// Windowed FFT analysis of the sidechain audio on its own thread
+//
+// The audio thread only mixes the incoming block to mono and copies it into a lock-free ring
+// (juce::AbstractFifo). The analysis thread wakes at the LED frame rate, runs a Hann-windowed
+// radix-2 FFT over the most recent FFT_SIZE samples, reduces it to log-spaced bands with
+// attack/release smoothing and spectral-flux onset detection, and publishes the result
+// through a TripleBuffer - so the analysis cost never lands on the realtime callback.
+class AudioAnalyser : public juce::Thread
+{
+public:
+    static constexpr int FFT_ORDER = 10;
+    static constexpr int FFT_SIZE = 1 << FFT_ORDER;
+
+    AudioAnalyser() : juce::Thread("KeyGlow Analysis") {}
+
+    ~AudioAnalyser() override
+    {
+        stopThread(2000);
+    }
+
+    // Allocate and precompute tables for a sample rate (call while the thread is stopped, never on the audio thread)
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        const int ringSize = juce::jmax(FFT_SIZE * 4, juce::nextPowerOfTwo(static_cast<int>(sampleRate / 5.0)));
+        ring.calloc(static_cast<size_t>(ringSize));
+        fifo.setTotalSize(ringSize);
+        fifo.reset();
+
+        history.calloc(FFT_SIZE);
+        real.calloc(FFT_SIZE);
+        imag.calloc(FFT_SIZE);
+        window.calloc(FFT_SIZE);
+        cosTable.calloc(FFT_SIZE / 2);
+        sinTable.calloc(FFT_SIZE / 2);
+        bitReversed.calloc(FFT_SIZE);
+
+        for (int i = 0; i < FFT_SIZE; i++)
+        {
+            window[i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * static_cast<float>(i) / FFT_SIZE);
+
+            int reversed = 0;
+            for (int bit = 0; bit < FFT_ORDER; bit++)
+                reversed |= ((i >> bit) & 1) << (FFT_ORDER - 1 - bit);
+            bitReversed[i] = reversed;
+        }
+
+        for (int i = 0; i < FFT_SIZE / 2; i++)
+        {
+            cosTable[i] = std::cos(juce::MathConstants<float>::twoPi * static_cast<float>(i) / FFT_SIZE);
+            sinTable[i] = -std::sin(juce::MathConstants<float>::twoPi * static_cast<float>(i) / FFT_SIZE);
+        }
+
+        // Log-spaced band edges from MIN_FREQUENCY up to MAX_FREQUENCY (or Nyquist)
+        // Low bands narrower than a bin share the nearest bin rather than drifting upwards
+        const float binHz = static_cast<float>(sampleRate) / FFT_SIZE;
+        const float maxFrequency = juce::jmin(MAX_FREQUENCY, static_cast<float>(sampleRate) * 0.5f);
+        for (int band = 0; band < AudioAnalysisFrame::NUM_BANDS; band++)
+        {
+            const float ratio = maxFrequency / MIN_FREQUENCY;
+            const float lower = MIN_FREQUENCY * std::pow(ratio, static_cast<float>(band) / AudioAnalysisFrame::NUM_BANDS);
+            const float upper = MIN_FREQUENCY * std::pow(ratio, static_cast<float>(band + 1) / AudioAnalysisFrame::NUM_BANDS);
+            bandStart[band] = juce::jlimit(1, FFT_SIZE / 2 - 1, juce::roundToInt(lower / binHz));
+            bandEnd[band] = juce::jlimit(bandStart[band] + 1, FFT_SIZE / 2, juce::roundToInt(upper / binHz));
+        }
+
+        juce::FloatVectorOperations::clear(smoothed, AudioAnalysisFrame::NUM_BANDS);
+        averageFlux = 0.0f;
+        onset = 0.0f;
+    }
+
+    void setEnabled(bool shouldBeEnabled)
+    {
+        if (enabled.exchange(shouldBeEnabled) != shouldBeEnabled)
+            notify();
+    }
+
+    bool isEnabled() const { return enabled.load(); }
+
+    void setFrameRate(int framesPerSecond) { frameRate = juce::jlimit(5, 120, framesPerSecond); }
+    void setSensitivity(float decibels) { sensitivityDb = decibels; }
+
+    // True while the last analysis showed anything worth sending
+    bool isActive() const { return active.load(); }
+
+    // MIDI note at the centre of a band, so the spectrum can use the note palette
+    static int getBandNote(int band)
+    {
+        const float centre = MIN_FREQUENCY * std::pow(MAX_FREQUENCY / MIN_FREQUENCY, (static_cast<float>(band) + 0.5f) / AudioAnalysisFrame::NUM_BANDS);
+        return juce::jlimit(0, 127, juce::roundToInt(69.0f + 12.0f * std::log2(centre / 440.0f)));
+    }
+
+    // Audio thread ------------------------------------------------------------
+    // Mix the block to mono into the ring (drops samples if the analysis thread falls behind)
+    void pushSamples(const juce::AudioBuffer<float>& buffer)
+    {
+        const int numChannels = buffer.getNumChannels();
+        const int numSamples = buffer.getNumSamples();
+        if (numChannels == 0 || !enabled.load(std::memory_order_relaxed))
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        const float gain = 1.0f / static_cast<float>(numChannels);
+        mixToMono(buffer, 0, ring.get() + start1, size1, gain);
+        mixToMono(buffer, size1, ring.get() + start2, size2, gain);
+
+        fifo.finishedWrite(size1 + size2);
+    }
+
+    // Audio thread: latest analysis (call update() first)
+    TripleBuffer<AudioAnalysisFrame>& getFrames() { return frames; }
+
+    // Analysis thread ---------------------------------------------------------
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            if (!enabled.load())
+            {
+                fifo.finishedRead(fifo.getNumReady());  // Drop what is left - reader side, so no reset()
+                active = false;
+                wait(-1);
+                continue;
+            }
+
+            readNewSamples();
+            analyse(1.0f / static_cast<float>(frameRate.load()));
+
+            wait(juce::jmax(1, 1000 / frameRate.load()));
+        }
+    }
+
+private:
+    static constexpr float MIN_FREQUENCY = 40.0f;
+    static constexpr float MAX_FREQUENCY = 16000.0f;
+    static constexpr float FLOOR_DB = -60.0f;           // Band level 0
+    static constexpr float RELEASE_SECONDS = 0.15f;     // Band fall time (rise is immediate)
+    static constexpr float ONSET_DECAY_SECONDS = 0.2f;
+    static constexpr float ONSET_THRESHOLD = 1.5f;      // Flux relative to its running average
+
+    static void mixToMono(const juce::AudioBuffer<float>& buffer, int offset, float* dest, int numSamples, float gain)
+    {
+        if (numSamples <= 0)
+            return;
+
+        juce::FloatVectorOperations::copyWithMultiply(dest, buffer.getReadPointer(0, offset), gain, numSamples);
+        for (int channel = 1; channel < buffer.getNumChannels(); channel++)
+            juce::FloatVectorOperations::addWithMultiply(dest, buffer.getReadPointer(channel, offset), gain, numSamples);
+    }
+
+    // Slide everything that arrived since the last frame into the FFT_SIZE history window
+    void readNewSamples()
+    {
+        const int available = fifo.getNumReady();
+        const int skip = juce::jmax(0, available - FFT_SIZE);
+        if (skip > 0)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(skip, start1, size1, start2, size2);
+            fifo.finishedRead(size1 + size2);
+        }
+
+        const int numNew = available - skip;
+        if (numNew <= 0)
+            return;
+
+        memmove(history.get(), history.get() + numNew, static_cast<size_t>(FFT_SIZE - numNew) * sizeof(float));
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numNew, start1, size1, start2, size2);
+        float* dest = history.get() + FFT_SIZE - numNew;
+        juce::FloatVectorOperations::copy(dest, ring.get() + start1, size1);
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy(dest + size1, ring.get() + start2, size2);
+        fifo.finishedRead(size1 + size2);
+    }
+
+    void analyse(float deltaSeconds)
+    {
+        // Windowed input in bit-reversed order, then in-place radix-2 butterflies
+        for (int i = 0; i < FFT_SIZE; i++)
+        {
+            real[bitReversed[i]] = history[i] * window[i];
+            imag[i] = 0.0f;
+        }
+
+        for (int size = 2; size <= FFT_SIZE; size <<= 1)
+        {
+            const int half = size >> 1;
+            const int step = FFT_SIZE / size;
+
+            for (int start = 0; start < FFT_SIZE; start += size)
+            {
+                for (int k = 0; k < half; k++)
+                {
+                    const float wr = cosTable[k * step];
+                    const float wi = sinTable[k * step];
+                    const int even = start + k;
+                    const int odd = even + half;
+
+                    const float tr = wr * real[odd] - wi * imag[odd];
+                    const float ti = wr * imag[odd] + wi * real[odd];
+                    real[odd] = real[even] - tr;
+                    imag[odd] = imag[even] - ti;
+                    real[even] += tr;
+                    imag[even] += ti;
+                }
+            }
+        }
+
+        // Bands: mean power -> dB (a full-scale sine reads 0 dB) -> 0..1 above FLOOR_DB
+        auto& frame = frames.getWriteBuffer();
+        const float release = std::exp(-deltaSeconds / RELEASE_SECONDS);
+        const float amplitudeScale = 4.0f / FFT_SIZE;  // Hann coherent gain 0.5, one-sided spectrum
+        float flux = 0.0f;
+
+        for (int band = 0; band < AudioAnalysisFrame::NUM_BANDS; band++)
+        {
+            float power = 0.0f;
+            for (int bin = bandStart[band]; bin < bandEnd[band]; bin++)
+                power += real[bin] * real[bin] + imag[bin] * imag[bin];
+            power /= static_cast<float>(bandEnd[band] - bandStart[band]);
+
+            const float decibels = 10.0f * std::log10(power * amplitudeScale * amplitudeScale + 1.0e-12f) + sensitivityDb.load();
+            const float level = juce::jlimit(0.0f, 1.0f, 1.0f - decibels / FLOOR_DB);
+
+            flux += juce::jmax(0.0f, level - smoothed[band]);
+            smoothed[band] = juce::jmax(level, smoothed[band] * release);
+            frame.bands[band] = smoothed[band];
+        }
+
+        // Onsets: spectral flux well above its recent average
+        if (flux > averageFlux * ONSET_THRESHOLD + 0.05f)
+            onset = 1.0f;
+        else
+            onset *= std::exp(-deltaSeconds / ONSET_DECAY_SECONDS);
+        averageFlux = juce::jmap(0.1f, averageFlux, flux);
+        frame.onset = onset;
+
+        float peak = onset;
+        for (float level : smoothed)
+            peak = juce::jmax(peak, level);
+        active = peak > 0.001f;
+
+        frames.publish();
+    }
+
+    double sampleRate = 44100.0;
+    std::atomic<bool> enabled { false };
+    std::atomic<bool> active { false };
+    std::atomic<int> frameRate { 30 };
+    std::atomic<float> sensitivityDb { 0.0f };
+
+    // Audio thread -> analysis thread
+    juce::AbstractFifo fifo { 1 };
+    juce::HeapBlock<float> ring;
+
+    // Analysis thread only
+    juce::HeapBlock<float> history, real, imag, window, cosTable, sinTable;
+    juce::HeapBlock<int> bitReversed;
+    int bandStart[AudioAnalysisFrame::NUM_BANDS] = {};
+    int bandEnd[AudioAnalysisFrame::NUM_BANDS] = {};
+    float smoothed[AudioAnalysisFrame::NUM_BANDS] = {};
+    float averageFlux = 0.0f;
+    float onset = 0.0f;
+
+    // Analysis thread -> audio thread
+    TripleBuffer<AudioAnalysisFrame> frames;
+};
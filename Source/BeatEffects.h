@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    BeatEffects.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Host transport, captured once per audio block
+// Frames extrapolate the musical position from it, so they stay sample-accurate at any
+// frame rate without asking the host again
+struct TransportSnapshot
+{
+    double ppqPosition = 0.0;     // Quarter notes at sampleTime
+    double bpm = 120.0;
+    bool isPlaying = false;
+    juce::int64 sampleTime = 0;   // Plugin sample clock at the start of the block
+    double sampleRate = 44100.0;
+
+    double getPpqAt(juce::int64 time) const
+    {
+        if (!isPlaying)
+            return ppqPosition;
+
+        return ppqPosition + static_cast<double>(time - sampleTime) / sampleRate * bpm / 60.0;
+    }
+};
+
+// Tempo-synced effects
+enum class BeatEffect
+{
+    Off = 0,
+    Strobe,       // Short full flash at the start of every cycle
+    Chase,        // A soft block travelling along each segment once per cycle
+    ColourCycle   // The whole strip turns once around the colour wheel per cycle
+};
+
+// Renders the beat effect layer (RGB float, written not added) for a musical position
+class BeatEffectRenderer
+{
+public:
+    // Cycle length in quarter notes for the "Beat Division" choices: 1 bar, 1/2, 1/4, 1/8, 1/16
+    static double getCycleLength(int division)
+    {
+        return 4.0 / static_cast<double>(1 << juce::jlimit(0, 4, division));
+    }
+
+    // Fill [firstPixel, firstPixel + numPixels) of an RGB float layer
+    static void render(float* rgb, int firstPixel, int numPixels, BeatEffect effect, double ppq, double cycleLength,
+                       float hue, float saturation, float value)
+    {
+        if (effect == BeatEffect::Off || numPixels <= 0)
+            return;
+
+        const double cycles = ppq / cycleLength;
+        const float phase = static_cast<float>(cycles - std::floor(cycles));
+        float* dest = rgb + firstPixel * 3;
+
+        switch (effect)
+        {
+            case BeatEffect::Strobe:
+            {
+                const float level = phase < STROBE_DUTY ? value : 0.0f;
+                fill(dest, numPixels, juce::Colour::fromHSV(hue, saturation, 1.0f, 1.0f), level);
+                break;
+            }
+
+            case BeatEffect::Chase:
+            {
+                const juce::Colour colour = juce::Colour::fromHSV(hue, saturation, 1.0f, 1.0f);
+                const float position = phase * static_cast<float>(numPixels);
+                const float halfWidth = juce::jmax(1.0f, static_cast<float>(numPixels) * CHASE_WIDTH * 0.5f);
+
+                for (int pixel = 0; pixel < numPixels; pixel++)
+                {
+                    // Distance along the segment, wrapping so the block re-enters at the start
+                    float distance = std::abs(static_cast<float>(pixel) - position);
+                    distance = juce::jmin(distance, static_cast<float>(numPixels) - distance);
+                    const float level = value * juce::jmax(0.0f, 1.0f - distance / halfWidth);
+
+                    dest[pixel * 3] = colour.getFloatRed() * level;
+                    dest[pixel * 3 + 1] = colour.getFloatGreen() * level;
+                    dest[pixel * 3 + 2] = colour.getFloatBlue() * level;
+                }
+                break;
+            }
+
+            case BeatEffect::ColourCycle:
+            {
+                float cycledHue = hue + phase;
+                cycledHue -= std::floor(cycledHue);
+                fill(dest, numPixels, juce::Colour::fromHSV(cycledHue, saturation, 1.0f, 1.0f), value);
+                break;
+            }
+
+            case BeatEffect::Off:
+            default:
+                break;
+        }
+    }
+
+private:
+    static constexpr float STROBE_DUTY = 0.15f;  // Fraction of the cycle the strobe is lit
+    static constexpr float CHASE_WIDTH = 0.125f; // Chase block width as a fraction of the segment
+
+    static void fill(float* dest, int numPixels, juce::Colour colour, float level)
+    {
+        const float red = colour.getFloatRed() * level;
+        const float green = colour.getFloatGreen() * level;
+        const float blue = colour.getFloatBlue() * level;
+
+        for (int pixel = 0; pixel < numPixels; pixel++)
+        {
+            dest[pixel * 3] = red;
+            dest[pixel * 3 + 1] = green;
+            dest[pixel * 3 + 2] = blue;
+        }
+    }
+};
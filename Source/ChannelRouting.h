@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    ChannelRouting.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ColourPalette.h"
+#include "SegmentMap.h"
+
+// Where the notes of one MIDI channel go
+struct ChannelRoute
+{
+    juce::uint32 segmentMask = SegmentMap::ALL_SEGMENTS;  // Bit s = segment s of the segment table
+    int palette = 0;                                       // Index into ChannelRouting::palettes
+};
+
+// MIDI channel -> segments and palette, for split keyboards and multitrack MIDI
+// Built on the message thread from the routing table and handed to the audio thread through a
+// TripleBuffer, so a note-on resolves its channel with one array read - no names or maps involved.
+// Palette 0 is the plugin's own palette; routes can add their own.
+struct ChannelRouting
+{
+    static constexpr int MAX_PALETTES = 4;
+
+    ChannelRoute routes[16];
+    PaletteTable palettes[MAX_PALETTES];
+    int numPalettes = 1;
+
+    // midiChannel is 1-16 as in juce::MidiMessage
+    const ChannelRoute& getRoute(int midiChannel) const { return routes[juce::jlimit(1, 16, midiChannel) - 1]; }
+
+    juce::Colour lookup(int midiNote, float velocity, int midiChannel) const
+    {
+        return palettes[getRoute(midiChannel).palette].lookup(midiNote, velocity, midiChannel);
+    }
+
+    // Parse the routing table (JSON array of routes) against the current segment names.
+    // Channels without a route light every segment with the plugin palette, so an empty table
+    // behaves as before, e.g.
+    //   [ { "channels": [1], "segments": ["Left"], "palette": { "mode": "single", "hue": 0.6 } },
+    //     { "channels": [2, 3], "segments": ["Right", 2] } ]
+    // Segments are referenced by name or by index in the segment table
+    void build(const juce::String& json, const PaletteSettings& defaults, const juce::StringArray& segmentNames)
+    {
+        for (auto& route : routes)
+            route = ChannelRoute();
+
+        palettes[0].build(defaults);
+        numPalettes = 1;
+
+        const juce::var parsed = juce::JSON::parse(json);
+        if (!parsed.isArray())
+            return;
+
+        for (const auto& entry : *parsed.getArray())
+        {
+            if (!entry.isObject())
+                continue;
+
+            ChannelRoute route;
+
+            if (entry.hasProperty("segments"))
+                route.segmentMask = parseSegmentMask(entry.getProperty("segments", juce::var()), segmentNames);
+
+            const juce::var palette = entry.getProperty("palette", juce::var());
+            if (palette.isObject())
+            {
+                if (numPalettes < MAX_PALETTES)
+                {
+                    route.palette = numPalettes++;
+                    palettes[route.palette].build(parsePaletteSettings(palette, defaults));
+                }
+                else
+                {
+                    DBG("ChannelRouting::build - more than " + juce::String(MAX_PALETTES - 1) + " route palettes, using the plugin palette");
+                }
+            }
+
+            // "channels": 1 or [1, 2, ...]
+            const juce::var channels = entry.getProperty("channels", juce::var());
+            if (channels.isArray())
+            {
+                for (const auto& channel : *channels.getArray())
+                    setRoute(static_cast<int>(channel), route);
+            }
+            else
+            {
+                setRoute(static_cast<int>(channels), route);
+            }
+        }
+    }
+
+private:
+    void setRoute(int midiChannel, const ChannelRoute& route)
+    {
+        if (midiChannel >= 1 && midiChannel <= 16)
+            routes[midiChannel - 1] = route;
+    }
+
+    static juce::uint32 parseSegmentMask(const juce::var& segments, const juce::StringArray& segmentNames)
+    {
+        if (!segments.isArray())
+            return SegmentMap::ALL_SEGMENTS;
+
+        juce::uint32 mask = 0;
+        for (const auto& segment : *segments.getArray())
+        {
+            const int index = segment.isString() ? segmentNames.indexOf(segment.toString())
+                                                 : static_cast<int>(segment);
+
+            if (index >= 0 && index < SegmentMap::MAX_SEGMENTS)
+            {
+                mask |= 1u << index;
+            }
+            else
+            {
+                DBG("ChannelRouting::build - unknown segment '" + segment.toString() + "'");
+            }
+        }
+
+        return mask;
+    }
+
+    static PaletteSettings parsePaletteSettings(const juce::var& palette, const PaletteSettings& defaults)
+    {
+        PaletteSettings settings = defaults;
+
+        if (palette.hasProperty("mode"))
+        {
+            const juce::String mode = palette.getProperty("mode", "").toString();
+            if (mode == "pitchClass")          settings.mode = PaletteMode::PitchClass;
+            else if (mode == "octaveGradient") settings.mode = PaletteMode::OctaveGradient;
+            else if (mode == "velocityHue")    settings.mode = PaletteMode::VelocityHue;
+            else if (mode == "midiChannel")    settings.mode = PaletteMode::MidiChannel;
+            else                               settings.mode = PaletteMode::Single;
+        }
+
+        settings.hue = juce::jlimit(0.0f, 1.0f, static_cast<float>(palette.getProperty("hue", settings.hue)));
+        settings.saturation = juce::jlimit(0.0f, 1.0f, static_cast<float>(palette.getProperty("saturation", settings.saturation)));
+        settings.value = juce::jlimit(0.0f, 1.0f, static_cast<float>(palette.getProperty("value", settings.value)));
+        settings.hueRange = juce::jlimit(0.0f, 1.0f, static_cast<float>(palette.getProperty("hueRange", settings.hueRange)));
+        return settings;
+    }
+};
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    ColourPalette.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// How a note's colour is chosen
+enum class PaletteMode
+{
+    Single = 0,      // Every note uses the base colour
+    PitchClass,      // Colour wheel over the 12 pitch classes (C = base hue)
+    OctaveGradient,  // Hue steps from octave to octave across the hue range
+    VelocityHue,     // Soft notes use the base hue, hard notes move across the hue range
+    MidiChannel      // One colour per MIDI channel
+};
+
+// Palette settings (copied from the parameters when the palette is rebuilt)
+struct PaletteSettings
+{
+    PaletteMode mode = PaletteMode::Single;
+    float hue = 0.667f;
+    float saturation = 1.0f;
+    float value = 1.0f;
+    float hueRange = 0.33f;  // Fraction of the colour wheel used by the gradient modes
+};
+
+// Precomputed note colours
+// Built on the message thread whenever a palette parameter changes, so a note-on
+// only needs a single table read instead of HSV maths on the audio thread
+struct PaletteTable
+{
+    static constexpr int VELOCITY_BUCKETS = 16;  // 8 MIDI velocity steps per bucket
+
+    juce::Colour noteColours[128][VELOCITY_BUCKETS];
+    juce::Colour channelColours[16][VELOCITY_BUCKETS];
+    PaletteMode mode = PaletteMode::Single;
+
+    // midiChannel is 1-16 as in juce::MidiMessage, velocity is 0..1
+    juce::Colour lookup(int midiNote, float velocity, int midiChannel) const
+    {
+        const int bucket = juce::jlimit(0, VELOCITY_BUCKETS - 1, static_cast<int>(velocity * VELOCITY_BUCKETS));
+
+        if (mode == PaletteMode::MidiChannel)
+            return channelColours[juce::jlimit(1, 16, midiChannel) - 1][bucket];
+
+        return noteColours[juce::jlimit(0, 127, midiNote)][bucket];
+    }
+
+    void build(const PaletteSettings& settings)
+    {
+        mode = settings.mode;
+
+        for (int bucket = 0; bucket < VELOCITY_BUCKETS; bucket++)
+        {
+            // Centre of the bucket, 0..1
+            const float velocity = (static_cast<float>(bucket) + 0.5f) / VELOCITY_BUCKETS;
+
+            for (int note = 0; note < 128; note++)
+                noteColours[note][bucket] = makeColour(settings, getNoteHueOffset(settings, note, velocity));
+
+            for (int channel = 0; channel < 16; channel++)
+                channelColours[channel][bucket] = makeColour(settings, static_cast<float>(channel) / 16.0f);
+        }
+    }
+
+private:
+    static float getNoteHueOffset(const PaletteSettings& settings, int note, float velocity)
+    {
+        switch (settings.mode)
+        {
+            case PaletteMode::PitchClass:     return static_cast<float>(note % 12) / 12.0f;
+            case PaletteMode::OctaveGradient: return settings.hueRange * static_cast<float>(note / 12) / 10.0f;
+            case PaletteMode::VelocityHue:    return settings.hueRange * velocity;
+            case PaletteMode::Single:
+            case PaletteMode::MidiChannel:
+            default:                          return 0.0f;
+        }
+    }
+
+    static juce::Colour makeColour(const PaletteSettings& settings, float hueOffset)
+    {
+        float hue = settings.hue + hueOffset;
+        hue -= std::floor(hue);
+        return juce::Colour::fromHSV(hue, settings.saturation, settings.value, 1.0f);
+    }
+};
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    ControlModulation.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Latest controller values (channel pressure, poly aftertouch, pitch bend, CCs)
+//
+// MIDI events only overwrite a value here - last value wins per destination - and the voices
+// read them once per output frame. A dense MPE controller stream therefore costs one store per
+// message instead of a pass over the voices per message.
+// Channels are 1-16 as in juce::MidiMessage; audio thread only.
+class ControlModulation
+{
+public:
+    // All values 0..1 except the pitch bend (-1..1)
+    void setChannelPressure(int midiChannel, float value) { channelPressure[index(midiChannel)] = value; }
+    void setPolyPressure(int midiChannel, int midiNote, float value) { polyPressure[index(midiChannel)][juce::jlimit(0, 127, midiNote)] = value; }
+    void setPitchBend(int midiChannel, float value) { pitchBend[index(midiChannel)] = value; }
+    void setTimbre(int midiChannel, float value) { timbre[index(midiChannel)] = value; }
+    void setBrightness(float value) { brightness = value; }
+
+    // Back to neutral when a controller is reassigned, so a value from the old CC does not stick
+    void resetBrightness() { brightness = 1.0f; }
+    void resetTimbre() { std::fill(std::begin(timbre), std::end(timbre), 0.5f); }
+
+    // A new note starts without the previous note's aftertouch
+    void resetNote(int midiChannel, int midiNote) { polyPressure[index(midiChannel)][juce::jlimit(0, 127, midiNote)] = 0.0f; }
+
+    float getBrightness() const { return brightness; }
+
+    // Channel pressure and poly aftertouch, whichever is stronger
+    float getPressure(int midiChannel, int midiNote) const
+    {
+        return juce::jmax(channelPressure[index(midiChannel)], polyPressure[index(midiChannel)][juce::jlimit(0, 127, midiNote)]);
+    }
+
+    // Timbre (centred) plus pitch bend, -2..2
+    float getHueModulation(int midiChannel) const
+    {
+        return (timbre[index(midiChannel)] - 0.5f) * 2.0f + pitchBend[index(midiChannel)];
+    }
+
+private:
+    static int index(int midiChannel) { return juce::jlimit(1, 16, midiChannel) - 1; }
+
+    float polyPressure[16][128] = {};
+    float channelPressure[16] = {};
+    float pitchBend[16] = {};
+    float timbre[16] = { 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f };
+    float brightness = 1.0f;  // Global, from the brightness CC
+};
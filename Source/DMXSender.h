@@ -199,6 +199,7 @@ public:
     // Standard DMX is 512 channels, but WLED uses 510
     static constexpr int WLED_LEDS_PER_UNIVERSE = 170; // Maximum LEDs per universe
     static constexpr int WLED_CHANNELS_PER_UNIVERSE = 510; // 170 LEDs * 3 RGB channels
+    static constexpr int DMX_CHANNELS_PER_UNIVERSE = 512;
     
     virtual ~DMXSender() = default;
     
@@ -211,89 +212,67 @@ public:
     // Send DMX data (splits across universes if needed)
     virtual void sendDMX(const uint8_t* dmxData, int numChannels) = 0;
     
-    // Send visual feedback pattern (bright edges, dim middle)
-    // Implemented in base class - uses sendDMX() which is protocol-specific
-    void sendVisualFeedbackPattern(int numLEDs, int offset, int maxLEDs)
+    // Set the number of channels per LED (3 = RGB/GRB/BGR, 4 = RGBW)
+    // Universes are filled with whole LEDs only, like WLED does (170 RGB or 128 RGBW LEDs per universe)
+    void setChannelsPerPixel(int channels)
+    {
+        channelsPerPixel = juce::jlimit(3, 4, channels);
+        channelsPerUniverse = (DMX_CHANNELS_PER_UNIVERSE / channelsPerPixel) * channelsPerPixel;
+        invalidateSentFrames(); // Universe boundaries moved
+    }
+    
+    int getChannelsPerPixel() const { return channelsPerPixel; }
+    
+    // Delta frames: a universe (or the whole Adalight frame) is only sent when its payload
+    // differs from what was last sent, or when the keep-alive interval has elapsed.
+    // E1.31 receivers treat a source as lost after 2.5 s without data, so unchanged
+    // universes are refreshed every keepAliveMs. 0 = send every universe on every frame
+    void setKeepAliveInterval(int milliseconds)
+    {
+        keepAliveMs = juce::jmax(0, milliseconds);
+    }
+    
+    int getKeepAliveInterval() const { return keepAliveMs; }
+    
+    // Force the next frame to be sent in full (e.g. after a reconnect or target change)
+    void invalidateSentFrames()
+    {
+        for (auto& slot : sentSlots)
+            slot.length = -1;
+    }
+    
+    // Render visual feedback pattern (bright edges, dim middle) into an RGB float frame
+    // The frame is expected to be cleared and to hold at least totalLEDs pixels
+    static void renderVisualFeedbackPattern(float* rgbFrame, int numLEDs, int offset, int totalLEDs)
     {
         if (numLEDs == 0)
             return;
         
-        // Calculate the actual range we need to cover
-        // Pattern starts at offset and extends for numLEDs
-        int patternStart = offset;
-        int patternEnd = offset + numLEDs - 1;
-        int totalLEDs = juce::jmax(maxLEDs, patternEnd + 1);
+        // Inner LEDs are dim: 0.35 ends up at ~10% brightness after the default gamma of 2.2
+        const float dimValue = 0.35f;
         
-        const int numChannels = totalLEDs * 3; // RGB per LED
-        if (numChannels > MAX_FEEDBACK_BUFFER_SIZE)
-            return;
-        
-        // Use pre-allocated buffer (no heap allocation on audio thread)
-        memset(feedbackBuffer, 0, numChannels);
-        
-        if (numLEDs == 1)
-        {
-            // Single LED - make it bright red at offset position
-            int channelIndex = patternStart * 3;
-            if (channelIndex + 2 < numChannels)
-            {
-                feedbackBuffer[channelIndex] = 255;     // R
-                feedbackBuffer[channelIndex + 1] = 0;   // G
-                feedbackBuffer[channelIndex + 2] = 0;   // B
-            }
-        }
-        else if (numLEDs == 2)
+        for (int i = 0; i < numLEDs; i++)
         {
-            // Two LEDs - both bright red at offset positions
-            for (int i = 0; i < 2; i++)
-            {
-                int ledPos = patternStart + i;
-                int channelIndex = ledPos * 3;
-                if (channelIndex + 2 < numChannels)
-                {
-                    feedbackBuffer[channelIndex] = 255;     // R
-                    feedbackBuffer[channelIndex + 1] = 0;   // G
-                    feedbackBuffer[channelIndex + 2] = 0;   // B
-                }
-            }
-        }
-        else
-        {
-            // Multiple LEDs - bright red at edges, dim in middle
-            // First LED (at offset) - bright red
-            int firstChannelIndex = patternStart * 3;
-            if (firstChannelIndex + 2 < numChannels)
-            {
-                feedbackBuffer[firstChannelIndex] = 255;     // R
-                feedbackBuffer[firstChannelIndex + 1] = 0;   // G
-                feedbackBuffer[firstChannelIndex + 2] = 0;   // B
-            }
+            int ledPos = offset + i;
+            if (ledPos < 0 || ledPos >= totalLEDs)
+                continue;
+            
+            float* pixel = rgbFrame + ledPos * 3;
             
-            // Last LED (at offset + numLEDs - 1) - bright red
-            int lastChannelIndex = patternEnd * 3;
-            if (lastChannelIndex + 2 < numChannels)
+            if (i == 0 || i == numLEDs - 1)
             {
-                feedbackBuffer[lastChannelIndex] = 255;     // R
-                feedbackBuffer[lastChannelIndex + 1] = 0;   // G
-                feedbackBuffer[lastChannelIndex + 2] = 0;   // B
+                // First and last LED - bright red
+                pixel[0] = 1.0f;
+                pixel[1] = 0.0f;
+                pixel[2] = 0.0f;
             }
-            
-            // Inner LEDs - dim (about 10% brightness)
-            const uint8_t dimValue = 25; // ~10% of 255
-            for (int i = 1; i < numLEDs - 1; i++)
+            else
             {
-                int ledPos = patternStart + i;
-                int channelIndex = ledPos * 3;
-                if (channelIndex + 2 < numChannels)
-                {
-                    feedbackBuffer[channelIndex] = dimValue;     // R
-                    feedbackBuffer[channelIndex + 1] = dimValue; // G
-                    feedbackBuffer[channelIndex + 2] = dimValue; // B
-                }
+                pixel[0] = dimValue;
+                pixel[1] = dimValue;
+                pixel[2] = dimValue;
             }
         }
-        
-        sendDMX(feedbackBuffer, numChannels);
     }
     
     // Send all LEDs off
@@ -303,7 +282,7 @@ public:
         if (numLEDs == 0)
             return;
         
-        const int numChannels = numLEDs * 3; // RGB per LED
+        const int numChannels = numLEDs * channelsPerPixel;
         if (numChannels > MAX_FEEDBACK_BUFFER_SIZE)
             return;
         
@@ -311,9 +290,54 @@ public:
         sendDMX(feedbackBuffer, numChannels);
     }
     
+protected:
+    // Decide whether a packet has to go out and, if so, record its payload as sent
+    // slot = universe index relative to the start universe, channelOffset = position in the frame
+    bool shouldSendSlot(int slot, int channelOffset, const uint8_t* data, int numChannels)
+    {
+        // Frames beyond the shadow copy cannot be compared - always send them
+        if (slot < 0 || slot >= MAX_SENT_SLOTS || channelOffset + numChannels > MAX_SENT_CHANNELS)
+            return true;
+        
+        auto& sent = sentSlots[slot];
+        uint8_t* shadow = sentFrame + channelOffset;
+        const juce::uint32 now = juce::Time::getMillisecondCounter();
+        
+        const bool changed = sent.length != numChannels || memcmp(shadow, data, static_cast<size_t>(numChannels)) != 0;
+        const bool keepAliveDue = keepAliveMs == 0 || now - sent.lastSentMs >= static_cast<juce::uint32>(keepAliveMs);
+        
+        if (!changed && !keepAliveDue)
+            return false;
+        
+        if (changed)
+        {
+            memcpy(shadow, data, static_cast<size_t>(numChannels));
+            sent.length = numChannels;
+        }
+        
+        sent.lastSentMs = now;
+        return true;
+    }
+    
+    int channelsPerPixel = 3;
+    int channelsPerUniverse = WLED_CHANNELS_PER_UNIVERSE;
+    
 private:
-    // Pre-allocated buffer for visual feedback patterns (avoids heap allocation on audio thread)
-    static constexpr int MAX_FEEDBACK_BUFFER_SIZE = 512 * 3;
+    // Shadow copy of the last sent frame, covering the largest frame the processor renders
+    static constexpr int MAX_SENT_CHANNELS = 512 * 4;
+    static constexpr int MAX_SENT_SLOTS = (MAX_SENT_CHANNELS + WLED_CHANNELS_PER_UNIVERSE - 1) / WLED_CHANNELS_PER_UNIVERSE;
+    
+    struct SentSlot
+    {
+        int length = -1;  // -1 = nothing sent yet, forces the next send
+        juce::uint32 lastSentMs = 0;
+    };
+    
+    SentSlot sentSlots[MAX_SENT_SLOTS];
+    uint8_t sentFrame[MAX_SENT_CHANNELS] = {0};
+    int keepAliveMs = 800;
+    
+    // Pre-allocated buffer for all-off frames (avoids heap allocation on audio thread)
+    static constexpr int MAX_FEEDBACK_BUFFER_SIZE = 512 * 4;
     uint8_t feedbackBuffer[MAX_FEEDBACK_BUFFER_SIZE] = {0};
 };
-
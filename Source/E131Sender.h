@@ -181,11 +181,15 @@ public:
     
     void setTargetIP(const juce::String& ipAddress) override
     {
+        if (ipAddress != targetIP)
+            invalidateSentFrames();
         targetIP = ipAddress;
     }
     
     void setUniverse(int universe) override
     {
+        if (universe != currentUniverse)
+            invalidateSentFrames();
         currentUniverse = universe;
     }
     
@@ -194,14 +198,23 @@ public:
         if (targetIP.isEmpty() || numChannels == 0)
             return;
         
-        // Split across multiple universes if needed (WLED uses 510 channels per universe)
+        // Split across multiple universes if needed (WLED uses 510 channels per universe for RGB, 512 for RGBW)
         int channelsRemaining = numChannels;
         int universeOffset = currentUniverse;
         int offset = 0;
         
         while (channelsRemaining > 0)
         {
-            int channelsInThisPacket = juce::jmin(channelsRemaining, WLED_CHANNELS_PER_UNIVERSE);
+            int channelsInThisPacket = juce::jmin(channelsRemaining, channelsPerUniverse);
+            
+            // Skip universes whose payload has not changed (until the keep-alive is due)
+            if (!shouldSendSlot(universeOffset - currentUniverse, offset, dmxData + offset, channelsInThisPacket))
+            {
+                channelsRemaining -= channelsInThisPacket;
+                offset += channelsInThisPacket;
+                universeOffset++;
+                continue;
+            }
             
             E131Packet packet;
             
@@ -251,7 +264,7 @@ public:
         }
     }
     
-    // sendVisualFeedbackPattern and sendAllLEDsOff are implemented in base class DMXSender
+    // sendAllLEDsOff is implemented in base class DMXSender
     
 private:
     juce::DatagramSocket socket;
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+    FrameCompositor.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PixelKernels.h"
+
+// Channel order of the LED hardware
+enum class ColourOrder
+{
+    RGB = 0,
+    GRB,
+    BGR,
+    RGBW
+};
+
+// Gamma * calibration lookup tables (R, G, B, W): 12-bit index in, 16-bit linear out
+//
+// A rebuild is 4096 pow() calls, so the plugin builds it on the message thread and hands it to
+// the audio thread through a TripleBuffer; brightness is not part of it (see FrameCompositor)
+struct OutputTransferTable
+{
+    static constexpr int SIZE = PixelKernels::INDEX_MAX + 1;
+
+    bool matches(float newGamma, float redGain, float greenGain, float blueGain) const
+    {
+        return newGamma == gamma && redGain == gains[0] && greenGain == gains[1] && blueGain == gains[2];
+    }
+
+    void build(float newGamma, float redGain, float greenGain, float blueGain)
+    {
+        gamma = newGamma;
+        gains[0] = redGain;
+        gains[1] = greenGain;
+        gains[2] = blueGain;
+        gains[3] = 1.0f; // White channel (RGBW) is not calibrated
+
+        for (int i = 0; i < SIZE; i++)
+        {
+            const float level = std::pow(static_cast<float>(i) / PixelKernels::INDEX_MAX, gamma);
+
+            for (int channel = 0; channel < 4; channel++)
+            {
+                const float value = juce::jmin(1.0f, level * gains[channel]) * PixelKernels::LINEAR_MAX;
+                lut[channel][i] = static_cast<uint16_t>(value + 0.5f);
+            }
+        }
+    }
+
+    uint16_t lut[4][SIZE] = {};
+    uint16_t gatherPadding[2] = {};  // AVX2 gathers read 32 bits, so the last entry reads one past it
+    float gamma = -1.0f;
+    float gains[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+};
+
+// Converts the composited frame (16-bit fixed-point RGB from the LayerStack) to the wire format
+//
+// Pipeline per frame:
+//   render(): vectorised 16-bit -> 12-bit index conversion, then one combined
+//      calibration * gamma LUT read per channel into a 16-bit linear buffer
+//      in the strip's colour order (summing the frame's drive level on the way), then
+//      brightness, power limiting and temporal dithering down to 8 bits on the wire in one pass
+//
+// The LUT reads are gathers: SSE2 and NEON have none, so they stay scalar there. With AVX2 the
+// RGBW pack (white extraction plus a four channel interleave) runs eight pixels per step, about
+// 1.5x faster than the scalar loop in KeyGlowBench. The three channel orders stay scalar: their
+// loop is already one load and one store per channel, and vpgatherdd plus the colour-order
+// shuffle showed no consistent gain over it (gathers are also slow on many AMD cores)
+//
+// The 16-bit stage keeps the bottom of the gamma curve from collapsing into a handful of
+// visible steps; the dither carries each channel's rounding error into the next frame
+class FrameCompositor
+{
+public:
+    // Allocate the conversion buffers (call from prepareToPlay - never on the audio thread)
+    void prepare(int numPixels)
+    {
+        if (numPixels <= maxPixels)
+            return;
+
+        maxPixels = numPixels;
+        indices.calloc(static_cast<size_t>(maxPixels) * 3);
+        linear.calloc(static_cast<size_t>(maxPixels) * 4);
+        ditherError.calloc(static_cast<size_t>(maxPixels) * 4);
+    }
+
+    int getMaxPixels() const { return maxPixels; }
+
+    FrameCompositor()
+    {
+        ownTransfer.build(2.2f, 1.0f, 1.0f, 1.0f);
+    }
+
+    // Gamma and per-channel calibration (white balance) from a table built elsewhere; it must stay
+    // unchanged while in use (the TripleBuffer read slot, swapped only on this thread)
+    void setTransferTable(const OutputTransferTable& table) { transfer = &table; }
+
+    // Same, but built in place when a value changes - only where a rebuild may take a while (output thread)
+    void setOutputTransfer(float gamma, float redGain, float greenGain, float blueGain)
+    {
+        if (!ownTransfer.matches(gamma, redGain, greenGain, blueGain))
+            ownTransfer.build(gamma, redGain, greenGain, blueGain);
+
+        transfer = &ownTransfer;
+    }
+
+    // Master brightness: a scale on the linear values, applied with the power limiter - changing it costs nothing
+    void setBrightness(float newBrightness) { brightness = juce::jlimit(0.0f, 1.0f, newBrightness); }
+
+    // Temporal dithering of the 16-bit linear values (otherwise they are rounded to 8 bits)
+    // Best at high output frame rates, where the alternating levels blend into one
+    void setDithering(bool shouldDither)
+    {
+        if (shouldDither && ! ditherEnabled && ditherError != nullptr)
+            juce::zeromem(ditherError.get(), static_cast<size_t>(maxPixels) * 4 * sizeof(uint16_t));
+
+        ditherEnabled = shouldDither;
+    }
+
+    bool isDithering() const { return ditherEnabled; }
+    
+    // Automatic brightness limiting: the estimated strip current is kept below maxMilliamps
+    // by scaling the whole frame. milliampsPerChannel is the draw of one channel at full level
+    // (about 20 mA for WS2812B). maxMilliamps <= 0 disables the limiter
+    void setPowerLimit(float maxMilliamps, float milliampsPerChannel)
+    {
+        powerLimitMilliamps = maxMilliamps;
+        channelMilliamps = milliampsPerChannel;
+    }
+    
+    // Telemetry of the last rendered frame
+    float getEstimatedMilliamps() const { return estimatedMilliamps; }   // Before limiting
+    float getPowerLimiterScale() const { return limiterScale; }          // 1 = limiter not engaged
+
+    void setColourOrder(ColourOrder order) { colourOrder = order; }
+    ColourOrder getColourOrder() const { return colourOrder; }
+
+    int getChannelsPerPixel() const { return colourOrder == ColourOrder::RGBW ? 4 : 3; }
+
+    // Convert the first numPixels of an RGB fixed-point frame to wire format
+    // Returns the number of channels written to dest
+    int render(const uint16_t* rgbFrame, uint8_t* dest, int numPixels)
+    {
+        numPixels = juce::jmin(numPixels, maxPixels);
+        if (numPixels <= 0)
+            return 0;
+
+        PixelKernels::fixedToIndex(rgbFrame, indices.get(), numPixels * 3);
+
+        uint32_t totalLevel = 0;
+
+        switch (colourOrder)
+        {
+            case ColourOrder::GRB:  totalLevel = packPixels<1, 0, 2>(numPixels); break;
+            case ColourOrder::BGR:  totalLevel = packPixels<2, 1, 0>(numPixels); break;
+            case ColourOrder::RGBW: totalLevel = packPixelsRGBW(numPixels); break;
+            case ColourOrder::RGB:
+            default:                totalLevel = packPixels<0, 1, 2>(numPixels); break;
+        }
+
+        // One scale factor per frame keeps hues intact while limiting
+        estimatedMilliamps = static_cast<float>(totalLevel) / PixelKernels::LINEAR_MAX * channelMilliamps * brightness;
+        limiterScale = 1.0f;
+        if (powerLimitMilliamps > 0.0f && estimatedMilliamps > powerLimitMilliamps)
+            limiterScale = powerLimitMilliamps / estimatedMilliamps;
+
+        const int scaleQ16 = static_cast<int>(brightness * limiterScale * 65536.0f);
+        const int numChannels = numPixels * getChannelsPerPixel();
+
+        if (ditherEnabled)
+            PixelKernels::quantiseTo8Bit<true>(linear.get(), ditherError.get(), dest, numChannels, scaleQ16);
+        else
+            PixelKernels::quantiseTo8Bit<false>(linear.get(), nullptr, dest, numChannels, scaleQ16);
+
+        return numChannels;
+    }
+
+private:
+    // Template per colour order keeps the per-pixel loop free of branches
+    // Returns the sum of all linear output values (drive level for the power estimate)
+    template <int first, int second, int third>
+    uint32_t packPixels(int numPixels)
+    {
+        const uint16_t* index = indices.get();
+        uint16_t* dest = linear.get();
+        const auto& lut = transfer->lut;
+        uint32_t total = 0;
+
+        for (int pixel = 0; pixel < numPixels; pixel++)
+        {
+            dest[0] = lut[first][index[first]];
+            dest[1] = lut[second][index[second]];
+            dest[2] = lut[third][index[third]];
+            total += static_cast<uint32_t>(dest[0] + dest[1] + dest[2]);
+            dest += 3;
+            index += 3;
+        }
+
+        return total;
+    }
+
+    // RGBW: the common (white) part of R, G and B is moved to the W channel
+    uint32_t packPixelsRGBW(int numPixels)
+    {
+        const uint16_t* index = indices.get();
+        uint16_t* dest = linear.get();
+        const auto& lut = transfer->lut;
+        uint32_t total = 0;
+        int pixel = 0;
+
+       #if KEYGLOW_SIMD_AVX2
+        // 32-bit gathers of 16-bit entries: the upper half belongs to the next entry and is masked off
+        const int* table = reinterpret_cast<const int*>(&lut[0][0]);
+        const __m256i channelStride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256i lowHalf = _mm256_set1_epi32(0xffff);
+        const __m256i greenTable = _mm256_set1_epi32(OutputTransferTable::SIZE);
+        const __m256i blueTable = _mm256_set1_epi32(OutputTransferTable::SIZE * 2);
+        const __m256i whiteTable = _mm256_set1_epi32(OutputTransferTable::SIZE * 3);
+        __m256i sum = _mm256_setzero_si256();
+
+        // Stops one pixel early: the index gather of the blue channel reads past the last pixel
+        for (; pixel + 8 < numPixels; pixel += 8)
+        {
+            __m256i red = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(index), channelStride, 2), lowHalf);
+            __m256i green = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(index + 1), channelStride, 2), lowHalf);
+            __m256i blue = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(index + 2), channelStride, 2), lowHalf);
+            __m256i white = _mm256_min_epi32(_mm256_min_epi32(red, green), blue);
+
+            red = _mm256_and_si256(_mm256_i32gather_epi32(table, _mm256_sub_epi32(red, white), 2), lowHalf);
+            green = _mm256_and_si256(_mm256_i32gather_epi32(table, _mm256_add_epi32(_mm256_sub_epi32(green, white), greenTable), 2), lowHalf);
+            blue = _mm256_and_si256(_mm256_i32gather_epi32(table, _mm256_add_epi32(_mm256_sub_epi32(blue, white), blueTable), 2), lowHalf);
+            white = _mm256_and_si256(_mm256_i32gather_epi32(table, _mm256_add_epi32(white, whiteTable), 2), lowHalf);
+            sum = _mm256_add_epi32(sum, _mm256_add_epi32(_mm256_add_epi32(red, green), _mm256_add_epi32(blue, white)));
+
+            // Interleave to R G B W per pixel: pair the channels in 32-bit lanes, then unpack the pairs
+            const __m256i redGreen = _mm256_or_si256(red, _mm256_slli_epi32(green, 16));
+            const __m256i blueWhite = _mm256_or_si256(blue, _mm256_slli_epi32(white, 16));
+            const __m256i low = _mm256_unpacklo_epi32(redGreen, blueWhite);   // Pixels 0, 1 | 4, 5
+            const __m256i high = _mm256_unpackhi_epi32(redGreen, blueWhite);  // Pixels 2, 3 | 6, 7
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_permute2x128_si256(low, high, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 16), _mm256_permute2x128_si256(low, high, 0x31));
+
+            dest += 32;
+            index += 24;
+        }
+
+        const __m128i halves = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        const __m128i pairs = _mm_add_epi32(halves, _mm_shuffle_epi32(halves, 0x4e));
+        total = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_add_epi32(pairs, _mm_shuffle_epi32(pairs, 0xb1))));
+       #endif
+
+        for (; pixel < numPixels; pixel++)
+        {
+            const uint16_t white = juce::jmin(index[0], index[1], index[2]);
+            dest[0] = lut[0][index[0] - white];
+            dest[1] = lut[1][index[1] - white];
+            dest[2] = lut[2][index[2] - white];
+            dest[3] = lut[3][white];
+            total += static_cast<uint32_t>(dest[0] + dest[1] + dest[2] + dest[3]);
+            dest += 4;
+            index += 3;
+        }
+
+        return total;
+    }
+
+    juce::HeapBlock<uint16_t> indices;      // 12-bit LUT indices (RGB)
+    juce::HeapBlock<uint16_t> linear;       // 16-bit linear output in wire order
+    juce::HeapBlock<uint16_t> ditherError;  // Carried quantisation error per wire channel
+    int maxPixels = 0;
+    bool ditherEnabled = true;
+
+    // Power limiter settings and telemetry
+    float powerLimitMilliamps = 0.0f;
+    float channelMilliamps = 20.0f;
+    float estimatedMilliamps = 0.0f;
+    float limiterScale = 1.0f;
+
+    ColourOrder colourOrder = ColourOrder::RGB;
+
+    // Calibration * gamma tables in use (ownTransfer unless a shared table was set)
+    OutputTransferTable ownTransfer;
+    const OutputTransferTable* transfer = &ownTransfer;
+    float brightness = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameCompositor)
+};
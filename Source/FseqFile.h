@@ -0,0 +1,490 @@
+/*
+  ==============================================================================
+
+    FseqFile.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ShowFile.h"
+
+// fseq v2 sequences, as used by xLights and Falcon Player (FPP)
+//
+// Layout (little endian):
+//   0   "PSEQ", uint16 channel data offset, uint8 minor version, uint8 major version (2),
+//       uint16 variable header offset, uint32 channels per frame, uint32 number of frames,
+//       uint8 step time (ms), uint8 flags, uint8 compression type, uint8 number of compression
+//       blocks, uint8 number of sparse ranges, uint8 flags, uint64 unique id
+//   32  compression block index: uint32 first frame, uint32 compressed size per block
+//       sparse ranges: uint24 first channel, uint24 channel count per range
+//       variable headers: uint16 length, two character code, data
+//   channel data offset: the frames, one block after another (or back to back when uncompressed)
+struct FseqFile
+{
+    static constexpr const char* FILE_EXTENSION = ".fseq";
+
+    // zstd (type 1) needs a library the project does not ship, zlib comes with JUCE
+    enum class Compression
+    {
+        None = 0,
+        Zstd = 1,
+        Zlib = 2
+    };
+
+    static constexpr int FIXED_HEADER_SIZE = 32;
+    static constexpr int MAX_BLOCKS = 255;                     // Minor version 0 keeps the block count in one byte
+    static constexpr int TARGET_BLOCK_BYTES = 1 << 17;         // Uncompressed frames per compression block
+    static constexpr juce::int64 MAX_BLOCK_BYTES = 64 << 20;  // Reader limit for blocks of foreign files
+
+    static void writeUInt16(uint8_t* dest, int value)
+    {
+        dest[0] = static_cast<uint8_t>(value & 0xff);
+        dest[1] = static_cast<uint8_t>((value >> 8) & 0xff);
+    }
+
+    static void writeUInt32(uint8_t* dest, juce::uint32 value)
+    {
+        for (int i = 0; i < 4; i++)
+            dest[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xff);
+    }
+
+    static int readUInt16(const uint8_t* source) { return source[0] | (source[1] << 8); }
+    static int readUInt24(const uint8_t* source) { return source[0] | (source[1] << 8) | (source[2] << 16); }
+
+    static juce::uint32 readUInt32(const uint8_t* source)
+    {
+        return static_cast<juce::uint32>(source[0]) | (static_cast<juce::uint32>(source[1]) << 8)
+             | (static_cast<juce::uint32>(source[2]) << 16) | (static_cast<juce::uint32>(source[3]) << 24);
+    }
+};
+
+// Writes an fseq v2 sequence, uncompressed or zlib-compressed per block
+// The frame count must be known up front (the block index precedes the data)
+class FseqWriter
+{
+public:
+    ~FseqWriter()
+    {
+        close();
+    }
+
+    bool open(const juce::File& file, int channelsPerFrame, int totalFrames, int stepTimeMs, FseqFile::Compression compressionType)
+    {
+        close();
+
+        if (compressionType == FseqFile::Compression::Zstd)
+        {
+            DBG("FseqWriter::open - zstd is not available, writing zlib blocks");
+            compressionType = FseqFile::Compression::Zlib;
+        }
+
+        numChannels = juce::jmax(1, channelsPerFrame);
+        numFrames = juce::jmax(0, totalFrames);
+        compression = compressionType;
+
+        // Blocks of about TARGET_BLOCK_BYTES, but never more than MAX_BLOCKS of them
+        framesPerBlock = numFrames;
+        numBlocks = 0;
+        if (compression != FseqFile::Compression::None && numFrames > 0)
+        {
+            framesPerBlock = juce::jmax(FseqFile::TARGET_BLOCK_BYTES / numChannels, (numFrames + FseqFile::MAX_BLOCKS - 1) / FseqFile::MAX_BLOCKS, 1);
+            numBlocks = (numFrames + framesPerBlock - 1) / framesPerBlock;
+            blockSizes.calloc(static_cast<size_t>(numBlocks));
+            blockData.malloc(static_cast<size_t>(framesPerBlock) * static_cast<size_t>(numChannels));
+        }
+
+        file.deleteFile();
+        stream = std::make_unique<juce::FileOutputStream>(file);
+        if (!stream->openedOk())
+        {
+            DBG("FseqWriter::open - cannot write " + file.getFullPathName());
+            stream.reset();
+            return false;
+        }
+
+        // Variable header: the sequence producer
+        static constexpr const char* PRODUCER = "KeyGlow";
+        const int producerLength = 4 + static_cast<int>(strlen(PRODUCER)) + 1;
+        const int variableHeaderOffset = FseqFile::FIXED_HEADER_SIZE + numBlocks * 8;
+        channelDataOffset = (variableHeaderOffset + producerLength + 3) & ~3;
+        stepTime = juce::jlimit(1, 255, stepTimeMs);
+
+        juce::HeapBlock<uint8_t> header(static_cast<size_t>(channelDataOffset), true);
+        writeHeader(header, variableHeaderOffset, numFrames);
+
+        uint8_t* producer = header + variableHeaderOffset;
+        FseqFile::writeUInt16(producer, producerLength);
+        producer[2] = 's';
+        producer[3] = 'p';
+        memcpy(producer + 4, PRODUCER, strlen(PRODUCER));
+
+        stream->write(header, static_cast<size_t>(channelDataOffset));
+
+        framesWritten = 0;
+        framesInBlock = 0;
+        blocksWritten = 0;
+        return true;
+    }
+
+    // Frames shorter than the channel count are padded with zeros, longer ones are cut
+    void writeFrame(const uint8_t* data, int frameChannels)
+    {
+        if (stream == nullptr || framesWritten >= numFrames)
+            return;
+
+        frameChannels = data != nullptr ? juce::jlimit(0, numChannels, frameChannels) : 0;
+
+        if (compression == FseqFile::Compression::None)
+        {
+            stream->write(data, static_cast<size_t>(frameChannels));
+            stream->writeRepeatedByte(0, static_cast<size_t>(numChannels - frameChannels));
+        }
+        else
+        {
+            uint8_t* dest = blockData + static_cast<size_t>(framesInBlock) * static_cast<size_t>(numChannels);
+            memcpy(dest, data, static_cast<size_t>(frameChannels));
+            juce::zeromem(dest + frameChannels, static_cast<size_t>(numChannels - frameChannels));
+
+            if (++framesInBlock == framesPerBlock)
+                writeBlock();
+        }
+
+        framesWritten++;
+    }
+
+    // Complete the block index and the frame count; false if the file is incomplete
+    bool close()
+    {
+        if (stream == nullptr)
+            return false;
+
+        if (framesInBlock > 0)
+            writeBlock();
+
+        // Rewrite the fixed header and block index with the real sizes
+        const int variableHeaderOffset = FseqFile::FIXED_HEADER_SIZE + numBlocks * 8;
+        juce::HeapBlock<uint8_t> header(static_cast<size_t>(variableHeaderOffset), true);
+        writeHeader(header, variableHeaderOffset, framesWritten);
+
+        stream->setPosition(0);
+        stream->write(header, static_cast<size_t>(variableHeaderOffset));
+        stream->flush();
+        const bool ok = stream->getStatus().wasOk();
+        stream.reset();
+
+        DBG("FseqWriter::close - " + juce::String(framesWritten) + " frames, " + juce::String(blocksWritten) + " blocks");
+        return ok;
+    }
+
+    // Resample a show file to the fixed fseq frame rate (each step shows the latest show frame)
+    static bool writeShow(ShowPlayer& show, const juce::File& file, int stepTimeMs, FseqFile::Compression compressionType)
+    {
+        if (show.getNumFrames() == 0)
+            return false;
+
+        const double ticksPerStep = show.getTicksPerSecond() * stepTimeMs / 1000.0;
+        const int totalFrames = static_cast<int>(static_cast<double>(show.getFrameTime(show.getNumFrames() - 1)) / ticksPerStep) + 1;
+
+        FseqWriter writer;
+        if (!writer.open(file, show.getMaxChannels(), totalFrames, stepTimeMs, compressionType))
+            return false;
+
+        int showFrame = -1;
+        const uint8_t* data = nullptr;
+        int numFrameChannels = 0;
+
+        for (int frame = 0; frame < totalFrames; frame++)
+        {
+            const double time = frame * ticksPerStep;
+            int latest = showFrame;
+            while (latest + 1 < show.getNumFrames() && static_cast<double>(show.getFrameTime(latest + 1)) <= time)
+                latest++;
+
+            if (latest != showFrame)
+            {
+                showFrame = latest;
+                data = show.getFrame(showFrame, numFrameChannels);
+            }
+
+            writer.writeFrame(data, data != nullptr ? numFrameChannels : 0);
+        }
+
+        return writer.close();
+    }
+
+private:
+    void writeHeader(uint8_t* header, int variableHeaderOffset, int frameCount) const
+    {
+        memcpy(header, "PSEQ", 4);
+        FseqFile::writeUInt16(header + 4, channelDataOffset);
+        header[6] = 0;   // Minor version
+        header[7] = 2;   // Major version
+        FseqFile::writeUInt16(header + 8, variableHeaderOffset);
+        FseqFile::writeUInt32(header + 10, static_cast<juce::uint32>(numChannels));
+        FseqFile::writeUInt32(header + 14, static_cast<juce::uint32>(frameCount));
+        header[18] = static_cast<uint8_t>(stepTime);
+        header[19] = 0;
+        header[20] = static_cast<uint8_t>(compression);
+        header[21] = static_cast<uint8_t>(numBlocks);
+        header[22] = 0;  // No sparse ranges
+        header[23] = 0;
+        FseqFile::writeUInt32(header + 24, static_cast<juce::uint32>(juce::Time::currentTimeMillis()));
+
+        for (int block = 0; block < numBlocks; block++)
+        {
+            FseqFile::writeUInt32(header + FseqFile::FIXED_HEADER_SIZE + block * 8, static_cast<juce::uint32>(block * framesPerBlock));
+            FseqFile::writeUInt32(header + FseqFile::FIXED_HEADER_SIZE + block * 8 + 4, blockSizes[block]);
+        }
+    }
+
+    void writeBlock()
+    {
+        juce::MemoryOutputStream compressed;
+        {
+            juce::GZIPCompressorOutputStream zlib(compressed);
+            zlib.write(blockData, static_cast<size_t>(framesInBlock) * static_cast<size_t>(numChannels));
+        }
+
+        stream->write(compressed.getData(), compressed.getDataSize());
+        if (blocksWritten < numBlocks)
+            blockSizes[blocksWritten] = static_cast<juce::uint32>(compressed.getDataSize());
+
+        blocksWritten++;
+        framesInBlock = 0;
+    }
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    FseqFile::Compression compression = FseqFile::Compression::None;
+    int numChannels = 0;
+    int numFrames = 0;
+    int stepTime = 50;
+    int channelDataOffset = 0;
+
+    int framesPerBlock = 0;
+    int numBlocks = 0;
+    juce::HeapBlock<juce::uint32> blockSizes;
+    juce::HeapBlock<uint8_t> blockData;
+    int framesInBlock = 0;
+    int blocksWritten = 0;
+    int framesWritten = 0;
+};
+
+// Streams an fseq v2 sequence from disk
+//
+// Only one compression block is held in memory at a time (or a single frame when the file is
+// uncompressed), so even long sequences play with a small, bounded buffer. Forward playback
+// decompresses each block once; seeking backwards rereads the block containing the frame.
+// Sparse ranges are expanded into a full frame, ready for the senders.
+class FseqReader
+{
+public:
+    bool open(const juce::File& file)
+    {
+        close();
+
+        stream = std::make_unique<juce::FileInputStream>(file);
+        uint8_t header[FseqFile::FIXED_HEADER_SIZE];
+        if (!stream->openedOk() || stream->read(header, FseqFile::FIXED_HEADER_SIZE) != FseqFile::FIXED_HEADER_SIZE)
+            return fail("cannot read " + file.getFullPathName());
+
+        if (memcmp(header, "PSEQ", 4) != 0 || header[7] != 2)
+            return fail(file.getFileName() + " is not an fseq v2 sequence");
+
+        channelDataOffset = FseqFile::readUInt16(header + 4);
+        const int variableHeaderOffset = FseqFile::readUInt16(header + 8);
+        frameBytes = static_cast<int>(FseqFile::readUInt32(header + 10));
+        numFrames = static_cast<int>(FseqFile::readUInt32(header + 14));
+        stepTime = juce::jmax(1, static_cast<int>(header[18]));
+        compression = static_cast<FseqFile::Compression>(header[20] & 0x0f);
+        const int blockCount = header[21] | ((header[20] & 0xf0) << 4);
+        const int numRanges = header[22];
+
+        if (compression == FseqFile::Compression::Zstd)
+            return fail(file.getFileName() + " is zstd-compressed - re-export it with zlib or without compression");
+
+        if (frameBytes <= 0 || numFrames < 0 || compression > FseqFile::Compression::Zlib
+            || variableHeaderOffset < FseqFile::FIXED_HEADER_SIZE + blockCount * 8 + numRanges * 6)
+            return fail(file.getFileName() + " has an invalid header");
+
+        // Block index and sparse ranges
+        juce::HeapBlock<uint8_t> tables(static_cast<size_t>(blockCount * 8 + numRanges * 6) + 1);
+        if (stream->read(tables, blockCount * 8 + numRanges * 6) != blockCount * 8 + numRanges * 6)
+            return fail(file.getFileName() + " is truncated");
+
+        juce::int64 offset = channelDataOffset;
+        int maxBlockFrames = 1;
+        for (int i = 0; i < blockCount; i++)
+        {
+            Block block;
+            block.firstFrame = static_cast<int>(FseqFile::readUInt32(tables + i * 8));
+            block.size = FseqFile::readUInt32(tables + i * 8 + 4);
+            block.offset = offset;
+            offset += block.size;
+
+            if (block.size == 0)
+                continue;
+
+            // Blocks must start inside the sequence and in order, or their frame spans go negative
+            if (block.firstFrame < 0 || block.firstFrame >= juce::jmax(1, numFrames)
+                || (!blocks.isEmpty() && block.firstFrame <= blocks.getLast().firstFrame))
+                return fail(file.getFileName() + " has an invalid block index");
+
+            blocks.add(block);
+        }
+
+        for (int i = 0; i < blocks.size(); i++)
+        {
+            const int end = i + 1 < blocks.size() ? blocks[i + 1].firstFrame : numFrames;
+            maxBlockFrames = juce::jmax(maxBlockFrames, end - blocks[i].firstFrame);
+        }
+
+        numChannels = 0;
+        juce::int64 rangeBytes = 0;
+        for (int i = 0; i < numRanges; i++)
+        {
+            const uint8_t* range = tables + blockCount * 8 + i * 6;
+            ranges.add({ FseqFile::readUInt24(range), FseqFile::readUInt24(range + 3) });
+            numChannels = juce::jmax(numChannels, ranges.getLast().start + ranges.getLast().count);
+            rangeBytes += ranges.getLast().count;
+        }
+
+        // getFrame() walks the ranges through one stored frame, so together they must fit in it
+        if (rangeBytes > frameBytes)
+            return fail(file.getFileName() + " has sparse ranges larger than its frames");
+
+        if (ranges.isEmpty())
+            numChannels = frameBytes;
+
+        const juce::int64 bufferBytes = static_cast<juce::int64>(compression == FseqFile::Compression::None ? 1 : maxBlockFrames) * frameBytes;
+        if (bufferBytes > FseqFile::MAX_BLOCK_BYTES)
+            return fail(file.getFileName() + " has blocks over " + juce::String(FseqFile::MAX_BLOCK_BYTES >> 20) + " MB");
+
+        blockData.malloc(static_cast<size_t>(bufferBytes));
+        if (!ranges.isEmpty())
+            frameBuffer.calloc(static_cast<size_t>(numChannels));
+
+        DBG("FseqReader::open - " + file.getFileName() + ": " + juce::String(numFrames) + " frames of "
+            + juce::String(numChannels) + " channels, " + juce::String(stepTime) + " ms");
+        return true;
+    }
+
+    void close()
+    {
+        stream.reset();
+        blocks.clearQuick();
+        ranges.clearQuick();
+        loadedFirstFrame = -1;
+        loadedNumFrames = 0;
+        numFrames = 0;
+    }
+
+    bool isOpen() const { return stream != nullptr; }
+    int getNumFrames() const { return numFrames; }
+    int getNumChannels() const { return numChannels; }
+    int getStepTimeMs() const { return stepTime; }
+
+    // Channel data of a frame (getNumChannels() bytes), valid until the next call
+    const uint8_t* getFrame(int frame)
+    {
+        if (!isOpen() || frame < 0 || frame >= numFrames)
+            return nullptr;
+
+        if (frame < loadedFirstFrame || frame >= loadedFirstFrame + loadedNumFrames)
+            if (!load(frame))
+                return nullptr;
+
+        const uint8_t* data = blockData + static_cast<size_t>(frame - loadedFirstFrame) * static_cast<size_t>(frameBytes);
+        if (ranges.isEmpty())
+            return data;
+
+        for (const auto& range : ranges)
+        {
+            memcpy(frameBuffer + range.start, data, static_cast<size_t>(range.count));
+            data += range.count;
+        }
+
+        return frameBuffer;
+    }
+
+private:
+    struct Block
+    {
+        int firstFrame = 0;
+        juce::uint32 size = 0;
+        juce::int64 offset = 0;
+    };
+
+    struct Range
+    {
+        int start = 0;
+        int count = 0;
+    };
+
+    bool fail(const juce::String& reason)
+    {
+        DBG("FseqReader::open - " + reason);
+        juce::ignoreUnused(reason);
+        close();
+        return false;
+    }
+
+    // Bring the frame's block (or the frame itself, uncompressed) into blockData
+    bool load(int frame)
+    {
+        if (compression == FseqFile::Compression::None)
+        {
+            stream->setPosition(channelDataOffset + static_cast<juce::int64>(frame) * frameBytes);
+            if (stream->read(blockData, frameBytes) != frameBytes)
+                return false;
+
+            loadedFirstFrame = frame;
+            loadedNumFrames = 1;
+            return true;
+        }
+
+        int index = blocks.size() - 1;
+        while (index > 0 && blocks[index].firstFrame > frame)
+            index--;
+        if (index < 0 || blocks[index].firstFrame > frame)
+            return false;
+
+        const auto& block = blocks.getReference(index);
+        const int end = index + 1 < blocks.size() ? blocks[index + 1].firstFrame : numFrames;
+        const int blockBytes = (end - block.firstFrame) * frameBytes;
+
+        juce::SubregionStream compressed(stream.get(), block.offset, block.size, false);
+        juce::GZIPDecompressorInputStream zlib(&compressed, false, juce::GZIPDecompressorInputStream::zlibFormat, blockBytes);
+
+        if (zlib.read(blockData, blockBytes) != blockBytes)
+        {
+            DBG("FseqReader::load - block " + juce::String(index) + " is damaged");
+            loadedNumFrames = 0;
+            return false;
+        }
+
+        loadedFirstFrame = block.firstFrame;
+        loadedNumFrames = end - block.firstFrame;
+        return true;
+    }
+
+    std::unique_ptr<juce::FileInputStream> stream;
+    FseqFile::Compression compression = FseqFile::Compression::None;
+    int channelDataOffset = 0;
+    int frameBytes = 0;        // Stored bytes per frame (sum of the sparse ranges, if any)
+    int numChannels = 0;       // Expanded frame size
+    int numFrames = 0;
+    int stepTime = 50;
+
+    juce::Array<Block> blocks;
+    juce::Array<Range> ranges;
+
+    juce::HeapBlock<uint8_t> blockData;   // One decompressed block
+    juce::HeapBlock<uint8_t> frameBuffer; // Expanded sparse frame
+    int loadedFirstFrame = -1;
+    int loadedNumFrames = 0;
+};
@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    KeyboardGeometry.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Range of LEDs lit by a single MIDI note
+struct NoteSpan
+{
+    int firstLED = 0;  // Absolute LED index (LED offset already applied)
+    int numLEDs = 0;   // 0 = note does not reach the strip
+};
+
+// Note -> LED span lookup table
+// Compiled once per configuration change so that the per-note cost on the audio thread is a single table read
+struct NoteSpanMap
+{
+    NoteSpan spans[128];
+
+    const NoteSpan& operator[](int midiNote) const
+    {
+        return spans[juce::jlimit(0, 127, midiNote)];
+    }
+};
+
+// Builds NoteSpanMaps, either by spreading notes evenly across the strip (linear)
+// or from the physical key positions of a real keyboard (piano geometry)
+class KeyboardGeometry
+{
+public:
+    // Standard acoustic piano dimensions (an octave of 7 white keys spans 164.5 mm)
+    static constexpr float WHITE_KEY_WIDTH_MM = 23.5f;
+    static constexpr float BLACK_KEY_WIDTH_MM = 13.7f;
+
+    static bool isBlackKey(int midiNote)
+    {
+        const int pitchClass = midiNote % 12;
+        return pitchClass == 1 || pitchClass == 3 || pitchClass == 6 || pitchClass == 8 || pitchClass == 10;
+    }
+
+    // Physical bounds of a key in mm, measured from the left edge of MIDI note 0 (C-1)
+    static void getStandardKeyBounds(int midiNote, float& leftMM, float& widthMM)
+    {
+        // Index of the white key at or directly left of each pitch class
+        static constexpr int whiteIndex[12] = { 0, 0, 1, 1, 2, 3, 3, 4, 4, 5, 5, 6 };
+
+        // Black keys are not centred on the white key boundary. Real keyboards split the
+        // C-E group into 5 and the F-B group into 7 equal back widths, which shifts the
+        // black key centres by these amounts (mm) relative to the boundary they sit on
+        static constexpr float blackKeyShift[12] = { 0.0f, -2.35f, 0.0f, 2.35f, 0.0f, 0.0f, -3.36f, 0.0f, 0.0f, 0.0f, 3.36f, 0.0f };
+
+        const int octave = midiNote / 12;
+        const int pitchClass = midiNote % 12;
+        const float whiteLeft = static_cast<float>(octave * 7 + whiteIndex[pitchClass]) * WHITE_KEY_WIDTH_MM;
+
+        if (isBlackKey(midiNote))
+        {
+            // Black key sits on the boundary to the right of its white key
+            float centre = whiteLeft + WHITE_KEY_WIDTH_MM + blackKeyShift[pitchClass];
+            leftMM = centre - BLACK_KEY_WIDTH_MM * 0.5f;
+            widthMM = BLACK_KEY_WIDTH_MM;
+        }
+        else
+        {
+            leftMM = whiteLeft;
+            widthMM = WHITE_KEY_WIDTH_MM;
+        }
+    }
+
+    // Parse a user-supplied key width table ("23.5, 13.7, 23.5, ..." in mm)
+    // Entries apply from the lowest note upwards; invalid or non-positive entries are skipped
+    static juce::Array<float> parseKeyWidthTable(const juce::String& text)
+    {
+        juce::Array<float> widths;
+        juce::StringArray tokens;
+        tokens.addTokens(text, ",; \t\r\n", "");
+        tokens.removeEmptyStrings();
+
+        for (const auto& token : tokens)
+        {
+            float width = token.getFloatValue();
+            if (width > 0.0f)
+                widths.add(width);
+        }
+
+        return widths;
+    }
+
+    // Linear mapping: spreads the note range evenly across the LED range (one LED per note)
+    static void buildLinear(NoteSpanMap& map, int lowestNote, int highestNote, int ledCount, int ledOffset)
+    {
+        const int noteRange = highestNote - lowestNote;
+
+        for (int note = 0; note < 128; note++)
+        {
+            auto& span = map.spans[note];
+            span.numLEDs = ledCount > 0 ? 1 : 0;
+
+            if (ledCount == 0 || noteRange == 0)
+            {
+                span.firstLED = ledOffset; // Single note maps to offset position
+                continue;
+            }
+
+            // Map note position to LED index with rounding to the nearest LED
+            // Position 0 -> LED 0, position noteRange -> LED (ledCount - 1)
+            int notePosition = juce::jlimit(lowestNote, highestNote, note) - lowestNote;
+            int ledIndex = (notePosition * (ledCount - 1) + noteRange / 2) / noteRange;
+            span.firstLED = juce::jlimit(0, ledCount - 1, ledIndex) + ledOffset;
+        }
+    }
+
+    // Piano geometry mapping: lights every LED that lies over a key
+    // The strip is assumed to start at the left edge of the lowest note's key.
+    // If customWidthsMM is non-empty, keys are laid out edge to edge with those widths instead
+    // of the standard white/black key positions (e.g. for LEDs mounted behind the key bed)
+    static void buildPianoGeometry(NoteSpanMap& map, int lowestNote, int highestNote, int ledCount, int ledOffset,
+                                   float ledsPerMetre, const juce::Array<float>& customWidthsMM)
+    {
+        const float ledPitchMM = 1000.0f / juce::jmax(1.0f, ledsPerMetre);
+
+        float originMM = 0.0f, unusedWidth = 0.0f;
+        getStandardKeyBounds(lowestNote, originMM, unusedWidth);
+
+        float customLeftMM = 0.0f;
+
+        for (int note = 0; note < 128; note++)
+        {
+            auto& span = map.spans[note];
+            span.firstLED = ledOffset;
+            span.numLEDs = 0;
+
+            if (note < lowestNote || note > highestNote || ledCount == 0)
+                continue;
+
+            float leftMM = 0.0f, widthMM = 0.0f;
+            if (customWidthsMM.isEmpty())
+            {
+                getStandardKeyBounds(note, leftMM, widthMM);
+                leftMM -= originMM;
+            }
+            else
+            {
+                // Keys beyond the end of the table repeat its last width
+                int tableIndex = juce::jmin(note - lowestNote, customWidthsMM.size() - 1);
+                leftMM = customLeftMM;
+                widthMM = customWidthsMM[tableIndex];
+                customLeftMM += widthMM;
+            }
+
+            // An LED belongs to a key when its centre ((i + 0.5) * pitch) lies over the key
+            int first = static_cast<int>(std::ceil(leftMM / ledPitchMM - 0.5f));
+            int last = static_cast<int>(std::ceil((leftMM + widthMM) / ledPitchMM - 0.5f)) - 1;
+
+            // Key narrower than the LED pitch: use the LED nearest to the key centre
+            if (last < first)
+                first = last = static_cast<int>((leftMM + widthMM * 0.5f) / ledPitchMM);
+
+            first = juce::jmax(0, first);
+            last = juce::jmin(ledCount - 1, last);
+
+            if (first > last)
+                continue; // Key lies beyond the end of the strip
+
+            span.firstLED = first + ledOffset;
+            span.numLEDs = last - first + 1;
+        }
+    }
+};
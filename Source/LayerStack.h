@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    LayerStack.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PixelKernels.h"
+
+// Layers, bottom to top
+enum class LayerId
+{
+    Audio = 0,   // Audio-reactive spectrum and onset flashes
+    Beat,        // Tempo-synced strobes, chases and colour cycles
+    Notes,       // Note voices and their glow
+    Particles,   // Note-triggered ripples and sparks
+    Feedback,    // Configuration feedback pattern (LED count / offset changes)
+    NumLayers
+};
+
+// One RGB float layer with a dirty range
+// Producers write float RGB (0..1, additive within the layer) and mark what they touched;
+// the stack only visits that range when compositing
+class Layer
+{
+public:
+    void prepare(int numPixels)
+    {
+        if (numPixels <= maxPixels)
+            return;
+
+        maxPixels = numPixels;
+        pixels.calloc(static_cast<size_t>(maxPixels) * 3);
+        resetDirty();
+    }
+
+    float* getPixels() { return pixels.get(); }
+    int getMaxPixels() const { return maxPixels; }
+
+    void markDirty(int firstPixel, int numPixels)
+    {
+        const int first = juce::jmax(0, firstPixel);
+        const int end = juce::jmin(maxPixels, firstPixel + numPixels);
+        if (end <= first)
+            return;
+
+        dirtyFirst = juce::jmin(dirtyFirst, first);
+        dirtyEnd = juce::jmax(dirtyEnd, end);
+    }
+
+    // Additively blend a colour into a pixel span (e.g. a note voice)
+    void addSpan(int firstPixel, int numPixels, float red, float green, float blue)
+    {
+        const int first = juce::jmax(0, firstPixel);
+        const int end = juce::jmin(maxPixels, firstPixel + numPixels);
+
+        for (int pixel = first; pixel < end; pixel++)
+        {
+            float* rgb = pixels.get() + pixel * 3;
+            rgb[0] += red;
+            rgb[1] += green;
+            rgb[2] += blue;
+        }
+
+        markDirty(firstPixel, numPixels);
+    }
+
+    bool isDirty() const { return dirtyEnd > dirtyFirst; }
+    int getDirtyFirst() const { return dirtyFirst; }
+    int getDirtyEnd() const { return dirtyEnd; }
+
+    void resetDirty()
+    {
+        dirtyFirst = std::numeric_limits<int>::max();
+        dirtyEnd = 0;
+    }
+
+    BlendMode blendMode = BlendMode::Add;
+    float opacity = 1.0f;
+
+private:
+    juce::HeapBlock<float> pixels;
+    int maxPixels = 0;
+    int dirtyFirst = std::numeric_limits<int>::max();
+    int dirtyEnd = 0;
+};
+
+// Composites the layers into one 16-bit fixed-point RGB frame
+//
+// Each layer costs one SIMD pass over its dirty range only: float -> fixed point, opacity,
+// blend into the accumulator, and clearing the layer for the next frame, all fused.
+// Overlapping content mixes by the layer's blend mode instead of overwriting
+class LayerStack
+{
+public:
+    // Allocate all layers (call from prepareToPlay - never on the audio thread)
+    void prepare(int numPixels)
+    {
+        for (auto& layer : layers)
+            layer.prepare(numPixels);
+
+        if (numPixels > maxPixels)
+        {
+            maxPixels = numPixels;
+            accumulator.calloc(static_cast<size_t>(maxPixels) * 3);
+        }
+    }
+
+    int getMaxPixels() const { return maxPixels; }
+
+    Layer& getLayer(LayerId id) { return layers[static_cast<int>(id)]; }
+
+    // Blend all dirty layers (bottom to top) over black and return the RGB fixed-point frame
+    const uint16_t* composite(int numPixels)
+    {
+        numPixels = juce::jmin(numPixels, maxPixels);
+        juce::zeromem(accumulator.get(), static_cast<size_t>(numPixels) * 3 * sizeof(uint16_t));
+
+        for (auto& layer : layers)
+        {
+            if (!layer.isDirty())
+                continue;
+
+            const int first = layer.getDirtyFirst();
+            const int end = juce::jmin(layer.getDirtyEnd(), numPixels);
+
+            if (end > first && layer.opacity > 0.0f)
+            {
+                float* src = layer.getPixels() + first * 3;
+                uint16_t* dest = accumulator.get() + first * 3;
+                const int numValues = (end - first) * 3;
+                const int opacityQ16 = static_cast<int>(juce::jlimit(0.0f, 1.0f, layer.opacity) * 65536.0f);
+
+                switch (layer.blendMode)
+                {
+                    case BlendMode::Max:    PixelKernels::blendLayer<BlendMode::Max>(src, dest, numValues, opacityQ16); break;
+                    case BlendMode::Screen: PixelKernels::blendLayer<BlendMode::Screen>(src, dest, numValues, opacityQ16); break;
+                    case BlendMode::Alpha:  PixelKernels::blendLayer<BlendMode::Alpha>(src, dest, numValues, opacityQ16); break;
+                    case BlendMode::Add:
+                    default:                PixelKernels::blendLayer<BlendMode::Add>(src, dest, numValues, opacityQ16); break;
+                }
+            }
+
+            // Anything outside the composited range is discarded as well
+            clearRange(layer, juce::jmax(first, end), layer.getDirtyEnd());
+            if (layer.opacity <= 0.0f)
+                clearRange(layer, first, end);
+
+            layer.resetDirty();
+        }
+
+        return accumulator.get();
+    }
+
+private:
+    static void clearRange(Layer& layer, int first, int end)
+    {
+        if (end > first)
+            juce::FloatVectorOperations::clear(layer.getPixels() + first * 3, (end - first) * 3);
+    }
+
+    Layer layers[static_cast<int>(LayerId::NumLayers)];
+    juce::HeapBlock<uint16_t> accumulator;
+    int maxPixels = 0;
+};
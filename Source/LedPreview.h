@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    LedPreview.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OutputScheduler.h"
+
+// Live view of the strip: one block per LED, drawn from the frames the output thread sends
+//
+// The output thread publishes every frame it sends into a TripleBuffer; this component picks up
+// the newest one on a 60 Hz timer, so neither side ever waits for the other. The frame is
+// decoded into a one pixel high image (one pixel per LED) with BitmapData writes and stretched
+// without smoothing, which keeps a repaint to a single image blit. The wire bytes have gamma
+// applied; it is undone here so the preview shows colours as they appear on the strip.
+// While the editor is hidden the timer drops to a slow poll and nothing is repainted.
+class LedPreview : public juce::Component,
+                   private juce::Timer
+{
+public:
+    explicit LedPreview(TripleBuffer<LedPreviewFrame>& framesToRead)
+        : frames(framesToRead)
+    {
+        setOpaque(true);
+        startTimerHz(FRAME_RATE);
+    }
+
+    ~LedPreview() override
+    {
+        stopTimer();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.fillAll(juce::Colour(0xff0b0e16));
+
+        if (image.isValid())
+        {
+            g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+            g.drawImage(image, getLocalBounds().toFloat(), juce::RectanglePlacement::stretchToFit);
+        }
+    }
+
+private:
+    static constexpr int FRAME_RATE = 60;
+    static constexpr int HIDDEN_INTERVAL_MS = 250;
+
+    void timerCallback() override
+    {
+        // Hidden (closed tab, minimised window): poll slowly and leave the frames unread
+        if (!isShowing())
+        {
+            if (getTimerInterval() != HIDDEN_INTERVAL_MS)
+                startTimer(HIDDEN_INTERVAL_MS);
+            return;
+        }
+
+        if (getTimerInterval() == HIDDEN_INTERVAL_MS)
+            startTimerHz(FRAME_RATE);
+
+        if (!frames.update())
+            return;
+
+        updateImage(frames.getReadBuffer());
+        repaint();
+    }
+
+    void updateImage(const LedPreviewFrame& frame)
+    {
+        const int channelsPerPixel = frame.colourOrder == ColourOrder::RGBW ? 4 : 3;
+        const int numPixels = frame.numChannels / channelsPerPixel;
+
+        if (numPixels == 0)
+        {
+            image = juce::Image();
+            return;
+        }
+
+        if (image.getWidth() != numPixels)
+            image = juce::Image(juce::Image::RGB, numPixels, 1, true, juce::SoftwareImageType());
+
+        if (frame.gamma != lutGamma)
+        {
+            // Wire level -> screen level
+            for (int i = 0; i < 256; i++)
+                displayLevel[i] = static_cast<uint8_t>(juce::roundToInt(std::pow(i / 255.0f, 1.0f / frame.gamma) * 255.0f));
+            lutGamma = frame.gamma;
+        }
+
+        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
+        const uint8_t* source = frame.data;
+
+        for (int x = 0; x < numPixels; x++)
+        {
+            int red, green, blue;
+            switch (frame.colourOrder)
+            {
+                case ColourOrder::GRB:  red = source[1]; green = source[0]; blue = source[2]; break;
+                case ColourOrder::BGR:  red = source[2]; green = source[1]; blue = source[0]; break;
+                case ColourOrder::RGBW:
+                    // The white channel carries the common part of R, G and B
+                    red = juce::jmin(255, source[0] + source[3]);
+                    green = juce::jmin(255, source[1] + source[3]);
+                    blue = juce::jmin(255, source[2] + source[3]);
+                    break;
+                case ColourOrder::RGB:
+                default:                red = source[0]; green = source[1]; blue = source[2]; break;
+            }
+
+            auto* pixel = reinterpret_cast<juce::PixelRGB*>(bitmap.getPixelPointer(x, 0));
+            pixel->setARGB(255, displayLevel[red], displayLevel[green], displayLevel[blue]);
+            source += channelsPerPixel;
+        }
+    }
+
+    TripleBuffer<LedPreviewFrame>& frames;
+    juce::Image image;
+    uint8_t displayLevel[256] = {};
+    float lutGamma = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LedPreview)
+};
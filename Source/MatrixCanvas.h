@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    MatrixCanvas.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Built-in wiring orders of LED matrix panels (all start at the top-left LED)
+enum class MatrixLayout
+{
+    Rows = 0,          // Every row left to right
+    Serpentine,        // Rows alternate left->right and right->left
+    Columns,           // Every column top to bottom
+    ColumnSerpentine   // Columns alternate top->bottom and bottom->top
+};
+
+// Wire pixel -> canvas pixel maps
+// A map holds, for every LED in wire order, the logical canvas index (y * width + x) it shows,
+// or -1 for LEDs that are not part of the canvas. Maps are built at configuration time, so
+// converting the canvas to wire order is a single gather pass.
+class MatrixPixelMap
+{
+public:
+    static void build(int16_t* map, int width, int height, MatrixLayout layout)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int wirePixel = 0;
+                switch (layout)
+                {
+                    case MatrixLayout::Serpentine:       wirePixel = y * width + ((y & 1) ? width - 1 - x : x); break;
+                    case MatrixLayout::Columns:          wirePixel = x * height + y; break;
+                    case MatrixLayout::ColumnSerpentine: wirePixel = x * height + ((x & 1) ? height - 1 - y : y); break;
+                    case MatrixLayout::Rows:
+                    default:                             wirePixel = y * width + x; break;
+                }
+
+                map[wirePixel] = static_cast<int16_t>(y * width + x);
+            }
+        }
+    }
+
+    // Load a pixel map file. Both formats list, for every canvas pixel in row-major order,
+    // the index of the LED that shows it (-1 = no LED), as WLED's ledmap.json does:
+    //   JSON - { "map": [ 0, 1, 2, ... ] } or a plain array
+    //   CSV  - one row of indices per canvas row, separated by commas or whitespace
+    // LEDs that no canvas pixel refers to stay dark. Returns false if the file cannot be used
+    static bool loadFromFile(const juce::File& file, int16_t* map, int width, int height)
+    {
+        if (!file.existsAsFile())
+            return false;
+
+        const int numPixels = width * height;
+        juce::Array<int> indices;
+
+        if (file.hasFileExtension("json"))
+        {
+            juce::var parsed = juce::JSON::parse(file.loadFileAsString());
+            if (parsed.isObject())
+                parsed = parsed.getProperty("map", juce::var());
+
+            if (!parsed.isArray())
+                return false;
+
+            for (const auto& value : *parsed.getArray())
+                indices.add(static_cast<int>(value));
+        }
+        else
+        {
+            juce::StringArray tokens;
+            tokens.addTokens(file.loadFileAsString(), ",; \t\r\n", "");
+            tokens.removeEmptyStrings();
+
+            for (const auto& token : tokens)
+                indices.add(token.getIntValue());
+        }
+
+        if (indices.size() < numPixels)
+            return false;
+
+        for (int wirePixel = 0; wirePixel < numPixels; wirePixel++)
+            map[wirePixel] = -1;
+
+        for (int logical = 0; logical < numPixels; logical++)
+        {
+            const int wirePixel = indices[logical];
+            if (wirePixel >= 0 && wirePixel < numPixels)
+                map[wirePixel] = static_cast<int16_t>(logical);
+        }
+
+        return true;
+    }
+};
+
+// 2-D RGB float canvas with a scrolling ring-buffer history (piano roll)
+//
+// Row 0 is the newest row. New rows are written at a moving origin instead of shifting the
+// canvas, and each row is stored twice (at r and r + height) so the visible window
+// [origin, origin + height) is always contiguous. Scrolling therefore costs one row copy
+// per frame, and the gather into wire order needs no wrap-around arithmetic.
+class MatrixCanvas
+{
+public:
+    // Allocate for up to maxPixels canvas pixels (call from prepareToPlay - never on the audio thread)
+    void prepare(int maxPixels)
+    {
+        if (maxPixels <= capacity)
+            return;
+
+        capacity = maxPixels;
+        rows.calloc(static_cast<size_t>(capacity) * 2 * 3);
+        width = height = 0;
+    }
+
+    // Resize within the allocated capacity and clear the history
+    void setSize(int newWidth, int newHeight)
+    {
+        if (newWidth * newHeight > capacity)
+            newWidth = newHeight = 0;
+
+        width = newWidth;
+        height = newHeight;
+        origin = 0;
+        rowsSinceLit = height;
+        juce::FloatVectorOperations::clear(rows.get(), capacity * 2 * 3);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // True while lit rows are still scrolling through the visible window
+    bool isScrolling() const { return rowsSinceLit < height; }
+
+    // Start a new newest row (scroll = true, once per frame period) or redraw the newest row in place
+    // (frames sent early for note events): returns width cleared RGB pixels to draw into
+    float* beginRow(bool scroll)
+    {
+        scrolled = scroll;
+        if (scroll)
+            origin = origin > 0 ? origin - 1 : juce::jmax(0, height - 1);
+
+        float* row = getRow(origin);
+        juce::FloatVectorOperations::clear(row, width * 3);
+        return row;
+    }
+
+    // Finish the row started by beginRow()
+    void commitRow(bool anythingLit)
+    {
+        juce::FloatVectorOperations::copy(getRow(origin + height), getRow(origin), width * 3);
+        if (anythingLit)
+            rowsSinceLit = 0;
+        else if (scrolled)
+            rowsSinceLit = juce::jmin(height, rowsSinceLit + 1);
+    }
+
+    // Add the visible canvas to an RGB float frame in wire order
+    void gather(float* dest, const int16_t* pixelMap, int numPixels) const
+    {
+        const float* window = getRow(origin);
+
+        for (int wirePixel = 0; wirePixel < numPixels; wirePixel++)
+        {
+            const int logical = pixelMap[wirePixel];
+            if (logical < 0)
+                continue;
+
+            const float* source = window + logical * 3;
+            float* rgb = dest + wirePixel * 3;
+            rgb[0] += source[0];
+            rgb[1] += source[1];
+            rgb[2] += source[2];
+        }
+    }
+
+private:
+    float* getRow(int row) const { return rows.get() + row * width * 3; }
+
+    juce::HeapBlock<float> rows;  // 2 * height rows of width RGB pixels
+    int capacity = 0;
+    int width = 0;
+    int height = 0;
+    int origin = 0;               // Storage row of the newest canvas row
+    int rowsSinceLit = 0;
+    bool scrolled = false;        // The current row was started by a scroll, not a redraw
+};
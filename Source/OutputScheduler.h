@@ -0,0 +1,630 @@
+/*
+  ==============================================================================
+
+    OutputScheduler.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DMXSender.h"
+#include "ArtNetSender.h"
+#include "E131Sender.h"
+#include "AdalightSender.h"
+#include "FrameCompositor.h"
+#include "AmbientRenderer.h"
+#include "SegmentMap.h"
+#include "TripleBuffer.h"
+#include "ShowFile.h"
+#include "FseqFile.h"
+
+// Everything the output thread needs to know about the output
+// (copied from the parameters on the audio thread, applied on the output thread)
+struct OutputConfig
+{
+    // Senders, one per destination of the segment map
+    OutputDestination destinations[SegmentMap::MAX_SEGMENTS];
+    int numDestinations = 0;
+    int keepAliveMs = 800;
+
+    // Output transfer, mirrored from the audio thread's compositor so ambient frames match note frames
+    ColourOrder colourOrder = ColourOrder::RGB;
+    float brightness = 1.0f;
+    float gamma = 2.2f;
+    float gains[3] = { 1.0f, 1.0f, 1.0f };
+    bool dithering = true;
+    float powerLimit = 0.0f;
+    float milliampsPerChannel = 20.0f;
+
+    // Segment layout (the idle animation fills each segment)
+    PixelRange segmentRanges[SegmentMap::MAX_SEGMENTS];
+    int numSegments = 0;
+
+    // Idle animation
+    AmbientSettings ambient;
+    int ambientFrameRate = 20;
+
+    bool operator== (const OutputConfig& other) const
+    {
+        if (numDestinations != other.numDestinations || numSegments != other.numSegments)
+            return false;
+
+        for (int d = 0; d < numDestinations; d++)
+            if (!(destinations[d] == other.destinations[d]))
+                return false;
+
+        for (int s = 0; s < numSegments; s++)
+            if (!(segmentRanges[s] == other.segmentRanges[s]))
+                return false;
+
+        return keepAliveMs == other.keepAliveMs
+            && colourOrder == other.colourOrder && brightness == other.brightness && gamma == other.gamma
+            && gains[0] == other.gains[0] && gains[1] == other.gains[1] && gains[2] == other.gains[2]
+            && dithering == other.dithering && powerLimit == other.powerLimit
+            && milliampsPerChannel == other.milliampsPerChannel
+            && ambient == other.ambient && ambientFrameRate == other.ambientFrameRate;
+    }
+
+    bool operator!= (const OutputConfig& other) const { return !(*this == other); }
+};
+
+// Latest frame sent to the strip, for the editor's preview: the wire bytes as sent,
+// plus the colour order and gamma needed to turn them back into screen colours
+struct LedPreviewFrame
+{
+    static constexpr int MAX_CHANNELS = SegmentMap::MAX_PIXELS * 4;
+
+    uint8_t data[MAX_CHANNELS] = {};
+    int numChannels = 0;
+    ColourOrder colourOrder = ColourOrder::RGB;
+    float gamma = 2.2f;
+};
+
+// What the output thread does with the show file
+enum class ShowMode
+{
+    Off = 0,
+    Record,   // Record every frame that is sent
+    Play      // Replace live output with the show file (or an fseq sequence)
+};
+
+// Output thread: owns the protocol senders and does all network / serial I/O
+// (started on the first prepareToPlay, so no sender exists until the host prepares the plugin)
+//
+// Frames cover the whole segment frame; every destination gets its own contiguous slice.
+// The audio thread renders note frames and hands them over with submitFrame() - it never
+// blocks on a socket or serial port. While no note frames arrive the thread renders the
+// ambient animation itself at a reduced frame rate, so an idle strip costs the audio thread
+// nothing. The first note frame cross-fades from the animation into note output; after
+// IDLE_TIMEOUT_MS without note frames the animation fades back in. With the animation off
+// (or at zero brightness) the thread sleeps until the next frame or configuration change.
+//
+// Note frames carry the wall-clock time their audio reaches the speakers and wait in a small
+// delay line until then, so light and sound line up regardless of the host's output latency.
+// The thread sleeps until shortly before a frame is due and spins the last half millisecond.
+// Frames without a due time (the configuration pattern) skip the delay line and go out at once.
+//
+// The thread also records what it sends to a show file, or plays one back straight from
+// its memory mapping in place of the live frames. Every frame it sends is published to the
+// editor's LED preview through a TripleBuffer.
+class OutputScheduler : public juce::Thread
+{
+public:
+    static constexpr int MAX_PIXELS = SegmentMap::MAX_PIXELS;
+    static constexpr int MAX_CHANNELS = MAX_PIXELS * 4;
+
+    OutputScheduler() : juce::Thread("KeyGlow Output")
+    {
+        ambientCompositor.prepare(MAX_PIXELS);
+        ambientFrame.calloc(static_cast<size_t>(MAX_PIXELS) * 3);
+    }
+
+    ~OutputScheduler() override
+    {
+        stopThread(2000);
+    }
+
+    // Audio thread ------------------------------------------------------------
+    // Queue a wire-format frame to be sent at dueMs (juce::Time::getMillisecondCounterHiRes() time,
+    // 0 = right away). Lock-free. If the delay line is full the frame is held back until there is room;
+    // a newer frame replaces a held one (every frame is a complete state), so the last frame of a
+    // burst - often the note-off - is delayed at worst, never lost
+    void submitFrame(const uint8_t* data, int numChannels, double dueMs = 0.0)
+    {
+        // Right away: handed over beside the delay line instead of waiting behind delayed frames
+        if (dueMs <= 0.0)
+        {
+            auto& frame = immediateFrames.getWriteBuffer();
+            frame.numChannels = juce::jlimit(0, MAX_CHANNELS, numChannels);
+            frame.dueMs = 0.0;
+            memcpy(frame.data, data, static_cast<size_t>(frame.numChannels));
+            immediateFrames.publish();
+            notify();
+            return;
+        }
+
+        flushHeldFrame();
+
+        if (heldFrameValid || !pushFrame(data, numChannels, dueMs))
+        {
+            heldFrame.numChannels = juce::jlimit(0, MAX_CHANNELS, numChannels);
+            heldFrame.dueMs = dueMs;
+            memcpy(heldFrame.data, data, static_cast<size_t>(heldFrame.numChannels));
+            heldFrameValid = true;
+        }
+    }
+
+    // Queue the held frame once the delay line has room again (every block)
+    void flushHeldFrame()
+    {
+        if (heldFrameValid && pushFrame(heldFrame.data, heldFrame.numChannels, heldFrame.dueMs))
+            heldFrameValid = false;
+    }
+
+    // Hand over a new configuration (only call when it changed - the copy is taken under a spin lock)
+    void setConfig(const OutputConfig& newConfig)
+    {
+        {
+            const juce::SpinLock::ScopedLockType lock(configLock);
+            pendingConfig = newConfig;
+            configPending = true;
+        }
+        notify();
+    }
+
+    // Message thread: start recording to / playing a show file, or stop (the file is opened on the output thread)
+    void setShow(ShowMode mode, const juce::File& file)
+    {
+        {
+            const juce::SpinLock::ScopedLockType lock(configLock);
+            pendingShowMode = mode;
+            pendingShowFile = file;
+            showPending = true;
+        }
+        notify();
+    }
+
+    // Stop all output (offline renders): queued frames are dropped, the idle animation pauses
+    // and configuration changes wait, so no sender is created while suspended
+    void setSuspended(bool shouldBeSuspended)
+    {
+        if (shouldBeSuspended)
+            heldFrameValid = false;
+
+        suspended = shouldBeSuspended;
+        notify();
+    }
+
+    // Message thread: every frame sent is published here (one reader - the editor's preview)
+    TripleBuffer<LedPreviewFrame>& getPreviewFrames() { return previewFrames; }
+
+    // Output thread -----------------------------------------------------------
+    void run() override
+    {
+        double lastLoopMs = juce::Time::getMillisecondCounterHiRes();
+        const double startMs = lastLoopMs;
+
+        while (!threadShouldExit())
+        {
+            applyPendingShow();
+
+            // While suspended a new configuration stays pending: no sender is created, no port opened
+            if (!suspended)
+                applyPendingConfig();
+
+            if (suspended)
+            {
+                frameQueue.finishedRead(frameQueue.getNumReady());
+                immediateFrames.update();
+                ambientMix = 0.0f;
+                receivedNoteFrame = false;
+                wait(-1);
+                lastLoopMs = juce::Time::getMillisecondCounterHiRes();
+                continue;
+            }
+
+            if (player.isOpen() || sequence.isOpen())
+            {
+                wait(playShowFrame());
+                lastLoopMs = juce::Time::getMillisecondCounterHiRes();
+                continue;
+            }
+
+            const double nowMs = juce::Time::getMillisecondCounterHiRes();
+            const float deltaSeconds = juce::jlimit(0.0f, 0.1f, static_cast<float>((nowMs - lastLoopMs) * 0.001));
+            lastLoopMs = nowMs;
+
+            // Release every frame that is due - only the newest of them is sent
+            double nextDueMs = 0.0;
+            const bool newFrame = releaseDueFrames(nowMs, nextDueMs);
+            if (newFrame)
+            {
+                lastNoteFrameMs = nowMs;
+                receivedNoteFrame = true;
+            }
+
+            // Ambient fades in slowly once notes have stopped and out quickly on the first note
+            const bool idle = !receivedNoteFrame || nowMs - lastNoteFrameMs >= IDLE_TIMEOUT_MS;
+            const bool ambientEnabled = config.ambient.isEnabled();
+            const float previousMix = ambientMix;
+            if (ambientEnabled)
+                fadingAmbient = config.ambient;  // Switching the animation off fades out its last look
+
+            if (idle && ambientEnabled)
+                ambientMix = juce::jmin(1.0f, ambientMix + deltaSeconds * 1000.0f / AMBIENT_FADE_IN_MS);
+            else
+                ambientMix = juce::jmax(0.0f, ambientMix - deltaSeconds * 1000.0f / AMBIENT_FADE_OUT_MS);
+
+            if (ambientMix > 0.0f && (newFrame || nowMs >= nextAmbientFrameMs))
+            {
+                sendAmbientFrame(nowMs - startMs);
+                nextAmbientFrameMs = nowMs + ambientIntervalMs;
+            }
+            else if (newFrame)
+            {
+                sendFrame(noteFrame.data, noteFrame.numChannels);
+            }
+            else if (previousMix > 0.0f && ambientMix <= 0.0f && idle)
+            {
+                // Animation switched off while idle - do not leave its last frame on the strip
+                for (int d = 0; d < config.numDestinations; d++)
+                    if (senders[d])
+                        senders[d]->sendAllLEDsOff(config.destinations[d].numPixels);
+            }
+
+            // Sleep until the next ambient frame, until the strip counts as idle, or indefinitely
+            int waitMs = -1;
+            if (ambientMix > 0.0f || (idle && ambientEnabled))
+                waitMs = juce::jmax(1, static_cast<int>(nextAmbientFrameMs - juce::Time::getMillisecondCounterHiRes()));
+            else if (ambientEnabled)
+                waitMs = juce::jmax(1, static_cast<int>(lastNoteFrameMs + IDLE_TIMEOUT_MS - nowMs));
+
+            // ... or until the next delayed frame is due, spinning only the last fraction of a millisecond
+            if (nextDueMs > 0.0)
+            {
+                const double untilDueMs = nextDueMs - juce::Time::getMillisecondCounterHiRes();
+                if (untilDueMs < SPIN_MS)
+                {
+                    juce::Thread::yield();
+                    continue;
+                }
+
+                // Rounded down, so the wake-up lands inside the spin window rather than after the due time
+                const int frameWaitMs = juce::jmax(1, static_cast<int>(untilDueMs - SPIN_MS));
+                waitMs = waitMs < 0 ? frameWaitMs : juce::jmin(waitMs, frameWaitMs);
+            }
+
+            wait(waitMs);
+        }
+    }
+
+private:
+    static constexpr double IDLE_TIMEOUT_MS = 500.0;   // No note frames for this long = idle
+    static constexpr float AMBIENT_FADE_IN_MS = 2000.0f;
+    static constexpr float AMBIENT_FADE_OUT_MS = 150.0f;
+    static constexpr double AMBIENT_BUDGET_MS = 4.0;   // Render + send time allowed per ambient frame
+    static constexpr double MAX_AMBIENT_INTERVAL_MS = 500.0;
+    static constexpr double SPIN_MS = 0.5;             // Yield instead of sleeping this close to a due frame
+    // Holds 63 frames: 200 ms Light Delay plus ~100 ms Auto Delay at 120 fps is 36, the rest is
+    // headroom for the event frames sent between clock frames
+    static constexpr int FRAME_QUEUE_SIZE = 64;
+
+    struct WireFrame
+    {
+        uint8_t data[MAX_CHANNELS];
+        int numChannels = 0;
+        double dueMs = 0.0;
+    };
+
+    // Audio thread: append a frame to the delay line, false if it is full
+    bool pushFrame(const uint8_t* data, int numChannels, double dueMs)
+    {
+        int start1, size1, start2, size2;
+        frameQueue.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 == 0)
+            return false;
+
+        auto& frame = queuedFrames[start1];
+        frame.numChannels = juce::jlimit(0, MAX_CHANNELS, numChannels);
+        frame.dueMs = dueMs;
+        memcpy(frame.data, data, static_cast<size_t>(frame.numChannels));
+        frameQueue.finishedWrite(1);
+        notify();
+        return true;
+    }
+
+    // Pop the queued frames that are due into noteFrame; nextDueMs is set to the first one still waiting
+    // An immediate frame is the newest of all, so it wins over delayed frames released with it
+    bool releaseDueFrames(double nowMs, double& nextDueMs)
+    {
+        bool released = false;
+
+        while (frameQueue.getNumReady() > 0)
+        {
+            int start1, size1, start2, size2;
+            frameQueue.prepareToRead(1, start1, size1, start2, size2);
+            const auto& frame = queuedFrames[start1];
+
+            if (frame.dueMs > nowMs)
+            {
+                nextDueMs = frame.dueMs;
+                break;
+            }
+
+            noteFrame.numChannels = frame.numChannels;
+            memcpy(noteFrame.data, frame.data, static_cast<size_t>(frame.numChannels));
+            frameQueue.finishedRead(1);
+            released = true;
+        }
+
+        if (immediateFrames.update())
+        {
+            const auto& frame = immediateFrames.getReadBuffer();
+            noteFrame.numChannels = frame.numChannels;
+            memcpy(noteFrame.data, frame.data, static_cast<size_t>(frame.numChannels));
+            released = true;
+        }
+
+        return released;
+    }
+
+    void applyPendingShow()
+    {
+        ShowMode mode;
+        juce::File file;
+        {
+            const juce::SpinLock::ScopedLockType lock(configLock);
+            if (!showPending)
+                return;
+
+            mode = pendingShowMode;
+            file = pendingShowFile;
+            showPending = false;
+        }
+
+        recorder.close();
+        player.close();
+        sequence.close();
+        showStartMs = juce::Time::getMillisecondCounterHiRes();
+        lastShowFrame = -1;
+
+        if (mode == ShowMode::Record)
+            recorder.open(file, 1000000.0);  // Microseconds
+        else if (mode == ShowMode::Play && file.hasFileExtension(FseqFile::FILE_EXTENSION))
+            sequence.open(file);
+        else if (mode == ShowMode::Play)
+            player.open(file);
+    }
+
+    // Send the show frame that is due (live frames are dropped meanwhile); returns the wait until the next one
+    int playShowFrame()
+    {
+        frameQueue.finishedRead(frameQueue.getNumReady());
+        immediateFrames.update();
+
+        const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - showStartMs;
+
+        // fseq: fixed frame steps, streamed block by block
+        if (sequence.isOpen())
+        {
+            const int step = sequence.getStepTimeMs();
+            const int frame = juce::jmin(sequence.getNumFrames() - 1, static_cast<int>(elapsedMs) / step);
+
+            if (frame > lastShowFrame)
+            {
+                if (const uint8_t* data = sequence.getFrame(frame))
+                    sendFrame(data, sequence.getNumChannels());
+                lastShowFrame = frame;
+            }
+
+            if (frame + 1 >= sequence.getNumFrames())
+                return -1;
+
+            return juce::jmax(1, static_cast<int>((frame + 1) * step - elapsedMs));
+        }
+
+        const double seconds = elapsedMs * 0.001;
+        const int frame = player.findFrame(seconds);
+
+        if (frame > lastShowFrame)
+        {
+            int numChannels = 0;
+            if (const uint8_t* data = player.getFrame(frame, numChannels))
+                sendFrame(data, numChannels);
+            lastShowFrame = frame;
+        }
+
+        // The last frame stays on the strip until the show mode changes
+        if (frame + 1 >= player.getNumFrames())
+            return -1;
+
+        const double untilNextMs = (player.getFrameSeconds(frame + 1) - seconds) * 1000.0;
+        return juce::jmax(1, static_cast<int>(untilNextMs));
+    }
+
+    void applyPendingConfig()
+    {
+        OutputConfig newConfig;
+        {
+            const juce::SpinLock::ScopedLockType lock(configLock);
+            if (!configPending)
+                return;
+
+            newConfig = pendingConfig;
+            configPending = false;
+        }
+
+        // Recreate senders on protocol changes, reconfigure them only where something changed
+        const int channelsPerPixel = newConfig.colourOrder == ColourOrder::RGBW ? 4 : 3;
+
+        for (int d = 0; d < SegmentMap::MAX_SEGMENTS; d++)
+        {
+            if (d >= newConfig.numDestinations)
+            {
+                senders[d].reset();
+                continue;
+            }
+
+            const auto& destination = newConfig.destinations[d];
+            const auto& previous = config.destinations[d];
+            const bool newSender = !senders[d] || destination.protocol != previous.protocol;
+            if (newSender)
+                senders[d] = createSender(destination.protocol);
+
+            auto& sender = *senders[d];
+            if (newSender || channelsPerPixel != sender.getChannelsPerPixel())
+                sender.setChannelsPerPixel(channelsPerPixel);
+
+            sender.setKeepAliveInterval(newConfig.keepAliveMs);
+
+            // Adalight: target = serial port, universe = baud rate (setUniverse() configures the baud rate)
+            // Network protocols: target = IP, universe = start universe
+            if (newSender || destination.target != previous.target)
+                sender.setTargetIP(destination.target);
+            if (newSender || destination.universe != previous.universe)
+                sender.setUniverse(destination.universe);
+        }
+
+        ambientCompositor.setColourOrder(newConfig.colourOrder);
+        ambientCompositor.setOutputTransfer(newConfig.gamma, newConfig.gains[0], newConfig.gains[1], newConfig.gains[2]);
+        ambientCompositor.setBrightness(newConfig.brightness);
+        ambientCompositor.setDithering(newConfig.dithering);
+        ambientCompositor.setPowerLimit(newConfig.powerLimit, newConfig.milliampsPerChannel);
+
+        if (newConfig.ambientFrameRate != config.ambientFrameRate)
+            ambientIntervalMs = 1000.0 / juce::jmax(1, newConfig.ambientFrameRate);
+
+        config = newConfig;
+    }
+
+    static std::unique_ptr<DMXSender> createSender(int protocol)
+    {
+        DBG("OutputScheduler::createSender - protocol: " + juce::String(protocol));
+
+        if (protocol == 0)
+            return std::make_unique<ArtNetSender>();   // Art-Net
+
+        if (protocol == 2)
+            return std::make_unique<AdalightSender>(); // Adalight (USB Serial)
+
+        return std::make_unique<E131Sender>();         // E1.31 (sACN), also the default for unknown protocols
+    }
+
+    // Send each destination its slice of a segment frame
+    void sendFrame(const uint8_t* data, int numChannels)
+    {
+        const int channelsPerPixel = config.colourOrder == ColourOrder::RGBW ? 4 : 3;
+
+        for (int d = 0; d < config.numDestinations; d++)
+        {
+            const auto& destination = config.destinations[d];
+            const int first = destination.firstPixel * channelsPerPixel;
+
+            // The last destination also takes anything past its end (the configuration feedback
+            // pattern may cover more LEDs than the strip to clear a previous range)
+            const int end = d == config.numDestinations - 1 ? numChannels
+                                                            : juce::jmin(numChannels, first + destination.numPixels * channelsPerPixel);
+
+            if (senders[d] && end > first)
+                senders[d]->sendDMX(data + first, end - first);
+        }
+
+        if (recorder.isOpen())
+        {
+            const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - showStartMs;
+            recorder.writeFrame(static_cast<juce::int64>(elapsedMs * 1000.0), data, numChannels);
+        }
+
+        // A few KB per frame; the preview picks up the newest whenever it repaints
+        auto& preview = previewFrames.getWriteBuffer();
+        preview.numChannels = juce::jmin(numChannels, LedPreviewFrame::MAX_CHANNELS);
+        preview.colourOrder = config.colourOrder;
+        preview.gamma = config.gamma;
+        memcpy(preview.data, data, static_cast<size_t>(preview.numChannels));
+        previewFrames.publish();
+    }
+
+    // Render the animation and mix it over the latest note frame in the wire domain
+    void sendAmbientFrame(double timeMs)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        const int numPixels = config.numDestinations > 0 ? config.destinations[config.numDestinations - 1].firstPixel
+                                                         + config.destinations[config.numDestinations - 1].numPixels : 0;
+        juce::zeromem(ambientFrame.get(), static_cast<size_t>(numPixels) * 3 * sizeof(uint16_t));
+
+        for (int s = 0; s < config.numSegments; s++)
+            ambientRenderer.render(ambientFrame.get(), config.segmentRanges[s].firstPixel, config.segmentRanges[s].numPixels,
+                                   timeMs * 0.001, fadingAmbient);
+
+        const int numChannels = ambientCompositor.render(ambientFrame.get(), mixBuffer, numPixels);
+
+        const int mix = juce::roundToInt(ambientMix * 256.0f);
+        const int totalChannels = mix < 256 ? juce::jmax(numChannels, receivedNoteFrame ? noteFrame.numChannels : 0) : numChannels;
+
+        if (mix < 256)
+        {
+            for (int i = 0; i < totalChannels; i++)
+            {
+                const int ambient = i < numChannels ? mixBuffer[i] : 0;
+                const int note = receivedNoteFrame && i < noteFrame.numChannels ? noteFrame.data[i] : 0;
+                mixBuffer[i] = static_cast<uint8_t>((note * (256 - mix) + ambient * mix) >> 8);
+            }
+        }
+
+        sendFrame(mixBuffer, totalChannels);
+
+        // Budget cap: halve the animation frame rate while frames run over budget,
+        // creep back towards the configured rate once they fit comfortably again
+        const double costMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+        const double targetIntervalMs = 1000.0 / juce::jmax(1, config.ambientFrameRate);
+
+        if (costMs > AMBIENT_BUDGET_MS)
+            ambientIntervalMs = juce::jmin(MAX_AMBIENT_INTERVAL_MS, ambientIntervalMs * 2.0);
+        else if (costMs < AMBIENT_BUDGET_MS * 0.5)
+            ambientIntervalMs = juce::jmax(targetIntervalMs, ambientIntervalMs * 0.9);
+    }
+
+    // Shared with the audio thread
+    juce::AbstractFifo frameQueue { FRAME_QUEUE_SIZE };
+    WireFrame queuedFrames[FRAME_QUEUE_SIZE];
+    TripleBuffer<WireFrame> immediateFrames;  // Frames due right away (newest wins)
+    juce::SpinLock configLock;
+    OutputConfig pendingConfig;
+    bool configPending = false;
+    std::atomic<bool> suspended { false };
+    ShowMode pendingShowMode = ShowMode::Off;
+    juce::File pendingShowFile;
+    bool showPending = false;
+    TripleBuffer<LedPreviewFrame> previewFrames;
+
+    // Audio thread only
+    WireFrame heldFrame;              // Newest frame that found the delay line full
+    bool heldFrameValid = false;
+
+    // Output thread only
+    OutputConfig config;
+    std::unique_ptr<DMXSender> senders[SegmentMap::MAX_SEGMENTS];
+    FrameCompositor ambientCompositor;
+    AmbientRenderer ambientRenderer;
+    AmbientSettings fadingAmbient;    // Last enabled animation settings
+    juce::HeapBlock<uint16_t> ambientFrame;
+    uint8_t mixBuffer[MAX_CHANNELS] = {0};
+    WireFrame noteFrame;              // Latest released note frame
+    double lastNoteFrameMs = 0.0;
+    bool receivedNoteFrame = false;
+    float ambientMix = 0.0f;          // 0 = note output only, 1 = ambient only
+    double nextAmbientFrameMs = 0.0;
+    double ambientIntervalMs = 50.0;
+    ShowRecorder recorder;
+    ShowPlayer player;
+    FseqReader sequence;
+    double showStartMs = 0.0;
+    int lastShowFrame = -1;           // Last show frame sent
+
+    JUCE_DECLARE_NON_COPYABLE (OutputScheduler)
+};
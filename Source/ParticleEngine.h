@@ -0,0 +1,218 @@
+/*
+  ==============================================================================
+
+    ParticleEngine.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Note-triggered effect types
+enum class ParticleEffect
+{
+    Off = 0,
+    Ripple,   // Two wavefronts travelling outwards from the key
+    Sparks    // A burst of sparks with random speeds that slow down and fade
+};
+
+// Fixed-pool particle engine for ripples and sparks travelling along the strip
+//
+// Particles are stored structure-of-arrays so the integrator can advance every particle
+// with a handful of vector operations per frame. The pool is allocated in prepare() and
+// never grows: spawns that do not fit are dropped and counted as overflows.
+// All other methods are called on the audio thread.
+class ParticleEngine
+{
+public:
+    // Allocate the pool (call from prepareToPlay - never on the audio thread)
+    void prepare(int maxParticles)
+    {
+        if (maxParticles <= capacity)
+            return;
+
+        capacity = maxParticles;
+        for (auto* block : { &position, &velocity, &damping, &life, &fadeRate, &red, &green, &blue, &scratch })
+            block->calloc(static_cast<size_t>(capacity));
+
+        numLive = 0;
+    }
+
+    void setEffect(ParticleEffect newEffect, float speedLEDsPerSecond, float lifetimeSeconds)
+    {
+        effect = newEffect;
+        speed = speedLEDsPerSecond;
+        lifetime = juce::jmax(0.01f, lifetimeSeconds);
+    }
+
+    bool isEnabled() const { return effect != ParticleEffect::Off; }
+
+    // Spawn the current effect at an LED position (called from note-on)
+    // Colour components are 0..1 and already scaled by velocity
+    void trigger(float ledPosition, float red, float green, float blue)
+    {
+        switch (effect)
+        {
+            case ParticleEffect::Ripple:
+                spawn(ledPosition, -speed, 0.0f, lifetime, red, green, blue);
+                spawn(ledPosition, speed, 0.0f, lifetime, red, green, blue);
+                break;
+
+            case ParticleEffect::Sparks:
+                for (int i = 0; i < SPARKS_PER_NOTE; i++)
+                {
+                    // Random direction and speed, randomised lifetime so the burst does not die at once
+                    const float direction = random.nextBool() ? 1.0f : -1.0f;
+                    const float sparkSpeed = speed * (0.3f + 0.7f * random.nextFloat()) * direction;
+                    const float sparkLife = lifetime * (0.5f + 0.5f * random.nextFloat());
+                    spawn(ledPosition, sparkSpeed, SPARK_DAMPING, sparkLife, red, green, blue);
+                }
+                break;
+
+            case ParticleEffect::Off:
+            default:
+                break;
+        }
+    }
+
+    // Advance all particles by deltaSeconds and remove the ones that faded out
+    void update(float deltaSeconds)
+    {
+        if (numLive == 0)
+        {
+            frameCostTicks = 0;
+            return;
+        }
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const float dt = juce::jlimit(0.0f, 0.25f, deltaSeconds);
+
+        // position += velocity * dt
+        juce::FloatVectorOperations::addWithMultiply(position.get(), velocity.get(), dt, numLive);
+
+        // velocity *= max(0, 1 - damping * dt)
+        juce::FloatVectorOperations::copyWithMultiply(scratch.get(), damping.get(), -dt, numLive);
+        juce::FloatVectorOperations::add(scratch.get(), 1.0f, numLive);
+        juce::FloatVectorOperations::clip(scratch.get(), scratch.get(), 0.0f, 1.0f, numLive);
+        juce::FloatVectorOperations::multiply(velocity.get(), scratch.get(), numLive);
+
+        // life -= fadeRate * dt
+        juce::FloatVectorOperations::addWithMultiply(life.get(), fadeRate.get(), -dt, numLive);
+
+        // Compact: move the last live particle into every dead slot
+        for (int i = 0; i < numLive;)
+        {
+            if (life[i] > 0.0f)
+            {
+                i++;
+                continue;
+            }
+
+            numLive--;
+            moveParticle(numLive, i);
+        }
+
+        frameCostTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    }
+
+    // Splat all particles into an RGB float frame, limited to [firstPixel, firstPixel + numPixels)
+    // Positions are fractional, so each particle is shared between its two nearest LEDs
+    void render(float* rgbFrame, int firstPixel, int numPixels)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const int lastPixel = firstPixel + numPixels - 1;
+
+        for (int i = 0; i < numLive; i++)
+        {
+            const float intensity = life[i] * life[i]; // Fade out smoothly towards the end of life
+            const float pos = position[i];
+            const int left = static_cast<int>(std::floor(pos));
+            const float fraction = pos - static_cast<float>(left);
+
+            splat(rgbFrame, left, (1.0f - fraction) * intensity, i, firstPixel, lastPixel);
+            splat(rgbFrame, left + 1, fraction * intensity, i, firstPixel, lastPixel);
+        }
+
+        frameCostTicks += juce::Time::getHighResolutionTicks() - startTicks;
+    }
+
+    void reset() { numLive = 0; }
+
+    // Statistics
+    int getCapacity() const { return capacity; }
+    int getNumLive() const { return numLive; }
+    int getOverflowCount() const { return overflowCount; }
+    double getFrameCostMilliseconds() const  // Integrator + splatting of the last frame
+    {
+        return juce::Time::highResolutionTicksToSeconds(frameCostTicks) * 1000.0;
+    }
+
+private:
+    static constexpr int SPARKS_PER_NOTE = 8;
+    static constexpr float SPARK_DAMPING = 1.5f; // Fraction of velocity lost per second
+
+    void spawn(float pos, float vel, float damp, float lifeSeconds, float r, float g, float b)
+    {
+        if (numLive >= capacity)
+        {
+            overflowCount++;
+            return;
+        }
+
+        const int i = numLive++;
+        position[i] = pos;
+        velocity[i] = vel;
+        damping[i] = damp;
+        life[i] = 1.0f;
+        fadeRate[i] = 1.0f / lifeSeconds;
+        red[i] = r;
+        green[i] = g;
+        blue[i] = b;
+    }
+
+    void moveParticle(int from, int to)
+    {
+        position[to] = position[from];
+        velocity[to] = velocity[from];
+        damping[to] = damping[from];
+        life[to] = life[from];
+        fadeRate[to] = fadeRate[from];
+        red[to] = red[from];
+        green[to] = green[from];
+        blue[to] = blue[from];
+    }
+
+    void splat(float* rgbFrame, int pixel, float weight, int particle, int firstPixel, int lastPixel) const
+    {
+        if (pixel < firstPixel || pixel > lastPixel || weight <= 0.0f)
+            return;
+
+        float* rgb = rgbFrame + pixel * 3;
+        rgb[0] += red[particle] * weight;
+        rgb[1] += green[particle] * weight;
+        rgb[2] += blue[particle] * weight;
+    }
+
+    // Structure-of-arrays particle state
+    juce::HeapBlock<float> position;   // LED index (fractional)
+    juce::HeapBlock<float> velocity;   // LEDs per second
+    juce::HeapBlock<float> damping;    // Velocity loss per second
+    juce::HeapBlock<float> life;       // 1 = just spawned, <= 0 = dead
+    juce::HeapBlock<float> fadeRate;   // Life lost per second
+    juce::HeapBlock<float> red, green, blue;
+    juce::HeapBlock<float> scratch;
+
+    int capacity = 0;
+    int numLive = 0;
+    int overflowCount = 0;
+    juce::int64 frameCostTicks = 0;
+
+    ParticleEffect effect = ParticleEffect::Off;
+    float speed = 40.0f;
+    float lifetime = 1.0f;
+    juce::Random random;
+};
@@ -0,0 +1,310 @@
+/*
+  ==============================================================================
+
+    PixelKernels.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// SIMD instruction set selection (compile-time, follows the target architecture flags)
+#if defined (__AVX2__)
+    #define KEYGLOW_SIMD_AVX2 1
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define KEYGLOW_SIMD_SSE2 1
+    #include <immintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+    #define KEYGLOW_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// Layer blend modes (all work on 16-bit fixed point, 65535 = full level)
+enum class BlendMode
+{
+    Add = 0,   // Saturating sum
+    Max,       // Brightest wins
+    Screen,    // 1 - (1 - a)(1 - b): brightens like add, but never clips
+    Alpha      // Crossfade by the layer opacity
+};
+
+// Vectorised inner loops of the frame pipeline
+// All kernels work on flat channel arrays, so pixel boundaries and colour order do not matter
+namespace PixelKernels
+{
+    // Resolution of the output LUT index (12 bits)
+    static constexpr int INDEX_BITS = 12;
+    static constexpr int INDEX_MAX = (1 << INDEX_BITS) - 1;
+
+    // Largest 16-bit linear value - 255 << 8, so value + dither error never exceeds 16 bits
+    static constexpr uint16_t LINEAR_MAX = 255 << 8;
+
+    // Quantise 16-bit linear values to 8 bits with temporal error diffusion
+    // The remainder of every channel is carried into the next frame, so low levels
+    // average out to their exact 16-bit value over time instead of collapsing into steps.
+    // With dither = false the values are simply rounded (error buffer is not touched)
+    // scaleQ16 (65536 = unity) is the power limiter's frame scale, applied in the same pass
+    template <bool dither>
+    inline void quantiseTo8Bit(const uint16_t* linear, uint16_t* error, uint8_t* dest, int num, int scaleQ16 = 65536)
+    {
+        int i = 0;
+        const bool scaled = scaleQ16 < 65536;
+        scaleQ16 = juce::jlimit(0, 65535, scaleQ16);
+
+       #if KEYGLOW_SIMD_AVX2
+        const __m256i round16 = _mm256_set1_epi16(128);
+        const __m256i lowByte16 = _mm256_set1_epi16(0xFF);
+        const __m256i scale16 = _mm256_set1_epi16(static_cast<short>(scaleQ16));
+        for (; i + 32 <= num; i += 32)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(linear + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(linear + i + 16));
+            if (scaled)
+            {
+                a = _mm256_mulhi_epu16(a, scale16);
+                b = _mm256_mulhi_epu16(b, scale16);
+            }
+            __m256i errA = dither ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(error + i)) : round16;
+            __m256i errB = dither ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(error + i + 16)) : round16;
+
+            // LINEAR_MAX + 255 fits in 16 bits, so the sum never wraps
+            __m256i sumA = _mm256_add_epi16(a, errA);
+            __m256i sumB = _mm256_add_epi16(b, errB);
+
+            if (dither)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(error + i), _mm256_and_si256(sumA, lowByte16));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(error + i + 16), _mm256_and_si256(sumB, lowByte16));
+            }
+
+            // packus works per 128-bit lane - restore element order afterwards
+            __m256i packed = _mm256_packus_epi16(_mm256_srli_epi16(sumA, 8), _mm256_srli_epi16(sumB, 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+       #endif
+
+       #if KEYGLOW_SIMD_SSE2
+        const __m128i round = _mm_set1_epi16(128);
+        const __m128i lowByte = _mm_set1_epi16(0xFF);
+        const __m128i scale = _mm_set1_epi16(static_cast<short>(scaleQ16));
+        for (; i + 16 <= num; i += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linear + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linear + i + 8));
+            if (scaled)
+            {
+                a = _mm_mulhi_epu16(a, scale);
+                b = _mm_mulhi_epu16(b, scale);
+            }
+            __m128i errA = dither ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(error + i)) : round;
+            __m128i errB = dither ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(error + i + 8)) : round;
+
+            __m128i sumA = _mm_add_epi16(a, errA);
+            __m128i sumB = _mm_add_epi16(b, errB);
+
+            if (dither)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(error + i), _mm_and_si128(sumA, lowByte));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(error + i + 8), _mm_and_si128(sumB, lowByte));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                             _mm_packus_epi16(_mm_srli_epi16(sumA, 8), _mm_srli_epi16(sumB, 8)));
+        }
+       #elif KEYGLOW_SIMD_NEON
+        const uint16x8_t round = vdupq_n_u16(128);
+        const uint16x8_t lowByte = vdupq_n_u16(0xFF);
+        const uint16x4_t scale = vdup_n_u16(static_cast<uint16_t>(scaleQ16));
+        for (; i + 16 <= num; i += 16)
+        {
+            uint16x8_t a = vld1q_u16(linear + i);
+            uint16x8_t b = vld1q_u16(linear + i + 8);
+            if (scaled)
+            {
+                // High half of the 32-bit products
+                a = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), scale), 16), vshrn_n_u32(vmull_u16(vget_high_u16(a), scale), 16));
+                b = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(b), scale), 16), vshrn_n_u32(vmull_u16(vget_high_u16(b), scale), 16));
+            }
+
+            uint16x8_t sumA = vaddq_u16(a, dither ? vld1q_u16(error + i) : round);
+            uint16x8_t sumB = vaddq_u16(b, dither ? vld1q_u16(error + i + 8) : round);
+
+            if (dither)
+            {
+                vst1q_u16(error + i, vandq_u16(sumA, lowByte));
+                vst1q_u16(error + i + 8, vandq_u16(sumB, lowByte));
+            }
+
+            vst1q_u8(dest + i, vcombine_u8(vshrn_n_u16(sumA, 8), vshrn_n_u16(sumB, 8)));
+        }
+       #endif
+
+        // Scalar tail (and fallback for other architectures)
+        for (; i < num; i++)
+        {
+            const int value = scaled ? (linear[i] * scaleQ16) >> 16 : linear[i];
+            const int sum = value + (dither ? error[i] : 128);
+            if (dither)
+                error[i] = static_cast<uint16_t>(sum & 0xFF);
+            dest[i] = static_cast<uint8_t>(sum >> 8);
+        }
+    }
+
+    // Convert 16-bit fixed point (65535 = full) to 12-bit LUT indices
+    inline void fixedToIndex(const uint16_t* src, uint16_t* dest, int num)
+    {
+        int i = 0;
+
+       #if KEYGLOW_SIMD_SSE2
+        for (; i + 8 <= num; i += 8)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_srli_epi16(a, 16 - INDEX_BITS));
+        }
+       #elif KEYGLOW_SIMD_NEON
+        for (; i + 8 <= num; i += 8)
+            vst1q_u16(dest + i, vshrq_n_u16(vld1q_u16(src + i), 16 - INDEX_BITS));
+       #endif
+
+        for (; i < num; i++)
+            dest[i] = static_cast<uint16_t>(src[i] >> (16 - INDEX_BITS));
+    }
+
+    // Blend one float layer (0..1) into a 16-bit fixed-point accumulator
+    // Fused single pass: convert, apply opacity, blend, and clear the layer for the next frame.
+    // opacityQ16: 65536 = opaque
+    template <BlendMode mode>
+    inline void blendLayer(float* layer, uint16_t* acc, int num, int opacityQ16)
+    {
+        int i = 0;
+        const bool faded = opacityQ16 < 65536;
+        const int opacity = juce::jlimit(0, 65535, opacityQ16);
+
+       #if KEYGLOW_SIMD_SSE2
+        const __m128 scale = _mm_set1_ps(65535.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128i bias = _mm_set1_epi32(32768);
+        const __m128i signFlip = _mm_set1_epi16(static_cast<short>(0x8000));
+        const __m128i allOnes = _mm_set1_epi16(-1);
+        const __m128i opacity16 = _mm_set1_epi16(static_cast<short>(opacity));
+        const __m128i inverse16 = _mm_set1_epi16(static_cast<short>(65535 - opacity));
+
+        for (; i + 8 <= num; i += 8)
+        {
+            // SSE2 has no unsigned 32 -> 16 pack: shift into the signed range, pack, shift back
+            __m128i lo = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(layer + i), scale)), bias);
+            __m128i hi = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(layer + i + 4), scale)), bias);
+            __m128i src = _mm_xor_si128(_mm_packs_epi32(lo, hi), signFlip);
+            _mm_storeu_ps(layer + i, zero);
+            _mm_storeu_ps(layer + i + 4, zero);
+
+            __m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+            __m128i result;
+
+            if (mode == BlendMode::Alpha)
+            {
+                result = _mm_add_epi16(_mm_mulhi_epu16(dst, inverse16), _mm_mulhi_epu16(src, opacity16));
+            }
+            else
+            {
+                if (faded)
+                    src = _mm_mulhi_epu16(src, opacity16);
+
+                if (mode == BlendMode::Add)
+                    result = _mm_adds_epu16(dst, src);
+                else if (mode == BlendMode::Max)
+                    result = _mm_add_epi16(_mm_subs_epu16(dst, src), src); // max_epu16 needs SSE4.1
+                else
+                    result = _mm_xor_si128(_mm_mulhi_epu16(_mm_xor_si128(dst, allOnes), _mm_xor_si128(src, allOnes)), allOnes);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), result);
+        }
+       #elif KEYGLOW_SIMD_NEON
+        const float32x4_t scale = vdupq_n_f32(65535.0f);
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const uint16x4_t opacity16 = vdup_n_u16(static_cast<uint16_t>(opacity));
+        const uint16x4_t inverse16 = vdup_n_u16(static_cast<uint16_t>(65535 - opacity));
+
+        auto mulhi = [] (uint16x8_t a, uint16x4_t b)
+        {
+            return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), b), 16),
+                                vshrn_n_u32(vmull_u16(vget_high_u16(a), b), 16));
+        };
+
+        auto mulhi8 = [] (uint16x8_t a, uint16x8_t b)
+        {
+            return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b)), 16),
+                                vshrn_n_u32(vmull_u16(vget_high_u16(a), vget_high_u16(b)), 16));
+        };
+
+        for (; i + 8 <= num; i += 8)
+        {
+            uint32x4_t lo = vcvtq_u32_f32(vmlaq_f32(half, vld1q_f32(layer + i), scale));
+            uint32x4_t hi = vcvtq_u32_f32(vmlaq_f32(half, vld1q_f32(layer + i + 4), scale));
+            uint16x8_t src = vcombine_u16(vqmovn_u32(lo), vqmovn_u32(hi));
+            vst1q_f32(layer + i, zero);
+            vst1q_f32(layer + i + 4, zero);
+
+            uint16x8_t dst = vld1q_u16(acc + i);
+            uint16x8_t result;
+
+            if (mode == BlendMode::Alpha)
+            {
+                result = vaddq_u16(mulhi(dst, inverse16), mulhi(src, opacity16));
+            }
+            else
+            {
+                if (faded)
+                    src = mulhi(src, opacity16);
+
+                if (mode == BlendMode::Add)
+                    result = vqaddq_u16(dst, src);
+                else if (mode == BlendMode::Max)
+                    result = vmaxq_u16(dst, src);
+                else
+                    result = vmvnq_u16(mulhi8(vmvnq_u16(dst), vmvnq_u16(src)));
+            }
+
+            vst1q_u16(acc + i, result);
+        }
+       #endif
+
+        // Scalar tail (and fallback for other architectures)
+        for (; i < num; i++)
+        {
+            // Products of two 16-bit values need unsigned 32-bit arithmetic
+            uint32_t src = static_cast<uint32_t>(juce::jlimit(0, 65535, static_cast<int>(layer[i] * 65535.0f + 0.5f)));
+            const uint32_t dst = acc[i];
+            const uint32_t alpha = static_cast<uint32_t>(opacity);
+            uint32_t result;
+            layer[i] = 0.0f;
+
+            if (mode == BlendMode::Alpha)
+            {
+                result = ((dst * (65535u - alpha)) >> 16) + ((src * alpha) >> 16);
+            }
+            else
+            {
+                if (faded)
+                    src = (src * alpha) >> 16;
+
+                if (mode == BlendMode::Add)
+                    result = juce::jmin(65535u, dst + src);
+                else if (mode == BlendMode::Max)
+                    result = juce::jmax(dst, src);
+                else
+                    result = 65535u - (((65535u - dst) * (65535u - src)) >> 16);
+            }
+
+            acc[i] = static_cast<uint16_t>(result);
+        }
+    }
+}
@@ -12,7 +12,7 @@
 
 //==============================================================================
 KeyGlowAudioProcessorEditor::KeyGlowAudioProcessorEditor (KeyGlowAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), ledPreview (p.getLedPreviewFrames())
 {
     // Install custom LookAndFeel (minimal, only tweaks knob / button drawing)
     customLookAndFeel = std::make_unique<KeyGlowLookAndFeel>();
@@ -22,7 +22,9 @@ KeyGlowAudioProcessorEditor::KeyGlowAudioProcessorEditor (KeyGlowAudioProcessor&
     setSize (600, 770);
     
     // Load background image if available
+    // The background covers the whole editor, so the host never has to paint behind it
     loadBackgroundImage();
+    setOpaque(true);
     
     // Title is now part of the background image, so we don't need to display it
     // titleLabel is kept in the class but not made visible
@@ -439,6 +441,9 @@ KeyGlowAudioProcessorEditor::KeyGlowAudioProcessorEditor (KeyGlowAudioProcessor&
     statusLabel.setColour(juce::Label::textColourId, juce::Colours::green);
     addAndMakeVisible(statusLabel);
     
+    // Live strip preview between the network section and the status line
+    addAndMakeVisible(ledPreview);
+    
     // Initial updates
     updateKnobValueLabels();
     
@@ -477,7 +482,12 @@ void KeyGlowAudioProcessorEditor::paint (juce::Graphics& g)
     // Draw background image if available
     if (hasBackgroundImage && backgroundImage.isValid())
     {
-        g.drawImage(backgroundImage, getLocalBounds().toFloat(), juce::RectanglePlacement::fillDestination);
+        // Resample once per size and display scale, then blit the cache pixel for pixel
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (backgroundCache.isNull() || scale != backgroundCacheScale)
+            renderBackgroundCache(scale);
+        
+        g.drawImageTransformed(backgroundCache, juce::AffineTransform::scale(1.0f / backgroundCacheScale));
         // Kein Overlay mehr - Hintergrundbild soll vollständig deckend sein
     }
     else
@@ -491,6 +501,9 @@ void KeyGlowAudioProcessorEditor::paint (juce::Graphics& g)
 
 void KeyGlowAudioProcessorEditor::resized()
 {
+    // Re-rendered at the new size on the next paint
+    backgroundCache = juce::Image();
+    
     const int margin = 20;
     const int padding = 15;
     
@@ -662,7 +675,8 @@ void KeyGlowAudioProcessorEditor::resized()
     universeEditor.setBounds(x + networkLabelWidth, networkCenterY - networkFieldHeight / 2, universeFieldWidth, networkFieldHeight);
     baudRateComboBox.setBounds(x + networkLabelWidth, networkCenterY - networkFieldHeight / 2, baudRateFieldWidth, networkFieldHeight);
     
-    // Status label below network section
+    // LED preview and status label below network section
+    ledPreview.setBounds(margin, networkSectionBounds.getBottom() + 2, getWidth() - 2 * margin, 6);
     statusLabel.setBounds(margin, networkSectionBounds.getBottom() + 10, getWidth() - 2 * margin, 20);
 }
 
@@ -774,7 +788,17 @@ void KeyGlowAudioProcessorEditor::updateStatusLabel()
     // Priority 1: Show active notes if playing
     if (activeNotes > 0)
     {
-        statusLabel.setText(juce::String(activeNotes) + (activeNotes == 1 ? " note active" : " notes active"), juce::dontSendNotification);
+        juce::String statusText = juce::String(activeNotes) + (activeNotes == 1 ? " note active" : " notes active");
+        
+        // Show when the power limiter is holding the strip below its budget
+        float limiterScale = audioProcessor.getPowerLimiterScale();
+        if (limiterScale < 1.0f)
+        {
+            statusText += " - power limited to " + juce::String(juce::roundToInt(limiterScale * 100.0f)) + "% ("
+                        + juce::String(juce::roundToInt(audioProcessor.getEstimatedMilliamps())) + " mA requested)";
+        }
+        
+        statusLabel.setText(statusText, juce::dontSendNotification);
         statusLabel.setColour(juce::Label::textColourId, juce::Colour(0xff1fa0ff)); // Accent-Blau für aktive Notes
         return;
     }
@@ -823,14 +847,29 @@ void KeyGlowAudioProcessorEditor::checkSerialPortConnection()
 void KeyGlowAudioProcessorEditor::loadBackgroundImage()
 {
     // Load from BinaryData (image added as binary resource via Projucer)
-    // Adjust name if your file is not exactly "Background.png"
+    // Background.jpg is cropped to the editor's 600x800 aspect ratio (the area fillDestination shows)
+    // and stored as JPEG - it is opaque, so PNG's alpha channel only cost binary size
     backgroundImage = juce::ImageCache::getFromMemory(
-        BinaryData::Background_png,
-        BinaryData::Background_pngSize);
+        BinaryData::Background_jpg,
+        BinaryData::Background_jpgSize);
 
     hasBackgroundImage = backgroundImage.isValid();
 }
 
+void KeyGlowAudioProcessorEditor::renderBackgroundCache(float scale)
+{
+    const int width = juce::jmax(1, juce::roundToInt(getWidth() * scale));
+    const int height = juce::jmax(1, juce::roundToInt(getHeight() * scale));
+    
+    // Opaque RGB - the resource has no transparency, and RGB blits faster than ARGB
+    backgroundCache = juce::Image(juce::Image::RGB, width, height, false);
+    backgroundCacheScale = scale;
+    
+    juce::Graphics g(backgroundCache);
+    g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+    g.drawImage(backgroundImage, backgroundCache.getBounds().toFloat(), juce::RectanglePlacement::fillDestination);
+}
+
 void KeyGlowAudioProcessorEditor::updateConnectionUI()
 {
     // Get protocol from ComboBox selection (more reliable than reading parameter)
@@ -994,12 +1033,20 @@ void KeyGlowAudioProcessorEditor::updateLEDCountWarning()
     int ledCount = static_cast<int>(*audioProcessor.getValueTreeState().getRawParameterValue(KeyGlowAudioProcessor::PARAM_LED_COUNT));
     int ledOffset = static_cast<int>(*audioProcessor.getValueTreeState().getRawParameterValue(KeyGlowAudioProcessor::PARAM_LED_OFFSET));
     int baudRate = static_cast<int>(*audioProcessor.getValueTreeState().getRawParameterValue(KeyGlowAudioProcessor::PARAM_BAUD_RATE));
+    int frameRate = static_cast<int>(*audioProcessor.getValueTreeState().getRawParameterValue(KeyGlowAudioProcessor::PARAM_FRAME_RATE));
     
     // Calculate max safe LED count
     int totalLEDs = ledOffset + ledCount;
-    int maxSafeLEDs = calculateMaxLEDCount(baudRate, 30);
+    int maxSafeLEDs = calculateMaxLEDCount(baudRate, frameRate);
     
-    if (totalLEDs > maxSafeLEDs)
+    if (totalLEDs > SegmentMap::MAX_DESTINATION_PIXELS)
+    {
+        // A serial port is a single sender, unlike network strips it cannot continue on the next universe
+        ledCountWarningLabel.setText("WARNING: LED Offset + Count = " + juce::String(totalLEDs) + " - only the first "
+                                     + juce::String(SegmentMap::MAX_DESTINATION_PIXELS) + " LEDs are sent over serial.",
+                                     juce::dontSendNotification);
+    }
+    else if (totalLEDs > maxSafeLEDs)
     {
         juce::String warningText = "WARNING: LED Offset + Count = " + juce::String(totalLEDs) + 
                                    " exceeds recommended " + juce::String(maxSafeLEDs) + 
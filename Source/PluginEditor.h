@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 #include "KeyGlowLookAndFeel.h"
+#include "LedPreview.h"
 
 //==============================================================================
 /**
@@ -85,11 +86,16 @@ private:
     
     juce::Label titleLabel;
     juce::Label statusLabel;
+    LedPreview ledPreview;  // What the strip is showing right now
     
     // Background image support
     juce::Image backgroundImage;
     bool hasBackgroundImage = false;
     
+    // Background resampled to the editor's physical size; rebuilt on resize or scale change
+    juce::Image backgroundCache;
+    float backgroundCacheScale = 0.0f;
+    
     // Section bounds for layout calculations
     juce::Rectangle<int> colorSectionBounds;
     juce::Rectangle<int> adsrSectionBounds;
@@ -130,6 +136,7 @@ private:
     void updateKnobValueLabels();
     void updateStatusLabel();
     void loadBackgroundImage();
+    void renderBackgroundCache(float scale);
     void updateConnectionUI();
     void refreshSerialPorts();
     void checkSerialPortConnection();
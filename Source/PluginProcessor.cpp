@@ -17,6 +17,8 @@ KeyGlowAudioProcessor::KeyGlowAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #else
+                       .withInput  ("Sidechain",  juce::AudioChannelSet::stereo(), false)  // Audio-reactive mode only
                       #endif
                        .withOutput ("Output",  juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -42,13 +44,73 @@ KeyGlowAudioProcessor::KeyGlowAudioProcessor()
                        juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
                    std::make_unique<juce::AudioParameterFloat>(PARAM_COLOR_VAL, "Color Value",
                        juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_PALETTE_MODE, "Palette", 0, 4, 0),  // 0 = Single colour (previous behaviour)
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_PALETTE_HUE_RANGE, "Palette Hue Range",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.33f),
                    std::make_unique<juce::AudioParameterInt>(PARAM_PROTOCOL, "Protocol", 0, 2, 2),  // 0 = Art-Net, 1 = E1.31, 2 = Adalight
                    std::make_unique<juce::AudioParameterInt>(PARAM_UNIVERSE, "Universe", 0, 63999, 1),  // Network protocols only (Art-Net, E1.31)
-                    std::make_unique<juce::AudioParameterInt>(PARAM_BAUD_RATE, "Baud Rate", 57600, 921600, 115200)  // Adalight serial only
+                    std::make_unique<juce::AudioParameterInt>(PARAM_BAUD_RATE, "Baud Rate", 57600, 921600, 115200),  // Adalight serial only
+                   std::make_unique<juce::AudioParameterInt>(PARAM_MAPPING_MODE, "Mapping Mode", 0, 1, 0),  // 0 = Linear, 1 = Piano geometry
+                   std::make_unique<juce::AudioParameterInt>(PARAM_LEDS_PER_METRE, "LEDs per Metre", 10, 240, 60),  // Strip density for piano geometry
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_BRIGHTNESS, "Brightness",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_GAMMA, "Gamma",
+                       juce::NormalisableRange<float>(1.0f, 3.0f, 0.01f), 2.2f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_COLOUR_ORDER, "Colour Order", 0, 3, 0),  // 0 = RGB, 1 = GRB, 2 = BGR, 3 = RGBW
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_CALIBRATION_RED, "Calibration Red",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_CALIBRATION_GREEN, "Calibration Green",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_CALIBRATION_BLUE, "Calibration Blue",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterBool>(PARAM_DITHERING, "Dithering", true),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_FRAME_RATE, "Frame Rate", 10, 120, 30),  // LED frames per second
+                   std::make_unique<juce::AudioParameterInt>(PARAM_KEEP_ALIVE, "Keep-Alive", 0, 5000, 800),  // ms, 0 = send every frame in full
+                   std::make_unique<juce::AudioParameterInt>(PARAM_POWER_LIMIT, "Power Limit", 0, 100000, 0),  // mA, 0 = off
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_MILLIAMPS_PER_CHANNEL, "mA per Channel",
+                       juce::NormalisableRange<float>(1.0f, 60.0f, 0.1f), 20.0f),  // WS2812B: ~20 mA per colour at full level
+                   std::make_unique<juce::AudioParameterInt>(PARAM_GLOW_MODE, "Glow Mode", 0, 2, 0),  // 0 = Off, 1 = Gaussian, 2 = Exponential
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_GLOW_RADIUS, "Glow Radius",
+                       juce::NormalisableRange<float>(0.5f, 64.0f, 0.1f), 6.0f),  // LEDs
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_GLOW_AMOUNT, "Glow Amount",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.6f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_GLOW_VELOCITY, "Glow Velocity",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.5f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_EFFECT_MODE, "Effect", 0, 2, 0),  // 0 = Off, 1 = Ripple, 2 = Sparks
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_EFFECT_SPEED, "Effect Speed",
+                       juce::NormalisableRange<float>(1.0f, 300.0f, 0.1f), 40.0f),  // LEDs per second
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_EFFECT_LIFETIME, "Effect Lifetime",
+                       juce::NormalisableRange<float>(0.05f, 5.0f, 0.01f), 1.0f),  // Seconds
+                   std::make_unique<juce::AudioParameterInt>(PARAM_EFFECT_BLEND, "Effect Blend", 0, 3, 0),  // 0 = Add, 1 = Max, 2 = Screen, 3 = Alpha
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_EFFECT_OPACITY, "Effect Opacity",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 1.0f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_AMBIENT_MODE, "Idle Animation", 0, 3, 0),  // 0 = Off, 1 = Breathing, 2 = Gradient, 3 = Noise
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_AMBIENT_BRIGHTNESS, "Idle Brightness",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.25f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_AMBIENT_SPEED, "Idle Speed",
+                       juce::NormalisableRange<float>(0.01f, 2.0f, 0.01f), 0.1f),  // Cycles per second
+                   std::make_unique<juce::AudioParameterInt>(PARAM_AMBIENT_FRAME_RATE, "Idle Frame Rate", 5, 60, 20),  // Kept low to spare serial bandwidth
+                   std::make_unique<juce::AudioParameterInt>(PARAM_BRIGHTNESS_CC, "Brightness CC", 0, 127, 0),  // 0 = Off, 1 = Mod wheel
+                   std::make_unique<juce::AudioParameterInt>(PARAM_HUE_CC, "Hue CC", 0, 127, 0),  // 0 = Off, 74 = MPE timbre
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_HUE_MOD_DEPTH, "Hue Mod Depth",
+                       juce::NormalisableRange<float>(0.0f, 0.5f, 0.001f), 0.0f),  // Fraction of the colour wheel; 0 = pitch bend ignored
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_PRESSURE_DEPTH, "Pressure Depth",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.0f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_AUDIO_MODE, "Audio Reactive", 0, 3, 0),  // 0 = Off, 1 = Spectrum, 2 = Flash, 3 = Both
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_AUDIO_SENSITIVITY, "Audio Sensitivity",
+                       juce::NormalisableRange<float>(-24.0f, 24.0f, 0.1f), 0.0f),  // dB
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_AUDIO_LEVEL, "Audio Level",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.5f),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_BEAT_EFFECT, "Beat Effect", 0, 3, 0),  // 0 = Off, 1 = Strobe, 2 = Chase, 3 = Colour cycle
+                   std::make_unique<juce::AudioParameterInt>(PARAM_BEAT_DIVISION, "Beat Division", 0, 4, 2),  // 0 = 1 bar ... 4 = 1/16
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_BEAT_LEVEL, "Beat Level",
+                       juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), 0.5f),
+                   std::make_unique<juce::AudioParameterFloat>(PARAM_LIGHT_DELAY, "Light Delay",
+                       juce::NormalisableRange<float>(0.0f, 200.0f, 0.1f), 0.0f),  // ms
+                   std::make_unique<juce::AudioParameterBool>(PARAM_AUTO_DELAY, "Auto Delay", true),
+                   std::make_unique<juce::AudioParameterInt>(PARAM_SHOW_MODE, "Show File", 0, 2, 0)  // 0 = Off, 1 = Record, 2 = Play
                })
 {
-    previousLEDCount = *parameters.getRawParameterValue(PARAM_LED_COUNT);
-    
     // Initialize ValueTree properties only if not already set (preserves saved state)
     if (!parameters.state.hasProperty(PARAM_WLED_IP))
         parameters.state.setProperty(PARAM_WLED_IP, "239.255.0.1", nullptr);
@@ -56,6 +118,21 @@ KeyGlowAudioProcessor::KeyGlowAudioProcessor()
     if (!parameters.state.hasProperty(PARAM_SERIAL_PORT))
         parameters.state.setProperty(PARAM_SERIAL_PORT, "", nullptr);
     
+    if (!parameters.state.hasProperty(PARAM_KEY_WIDTHS))
+        parameters.state.setProperty(PARAM_KEY_WIDTHS, "", nullptr);
+    
+    if (!parameters.state.hasProperty(PARAM_SEGMENTS))
+        parameters.state.setProperty(PARAM_SEGMENTS, "", nullptr);
+    
+    if (!parameters.state.hasProperty(PARAM_ROUTING))
+        parameters.state.setProperty(PARAM_ROUTING, "", nullptr);
+    
+    if (!parameters.state.hasProperty(PARAM_SHOW_FILE))
+        parameters.state.setProperty(PARAM_SHOW_FILE, "", nullptr);
+    
+    if (!parameters.state.hasProperty(PARAM_BOUNCE_FILE))
+        parameters.state.setProperty(PARAM_BOUNCE_FILE, "", nullptr);
+    
     // Read saved state into member variables BEFORE creating the sender
     currentProtocol = static_cast<int>(*parameters.getRawParameterValue(PARAM_PROTOCOL));
     currentWLEDIP = parameters.state.getProperty(PARAM_WLED_IP, "239.255.0.1").toString();
@@ -64,13 +141,49 @@ KeyGlowAudioProcessor::KeyGlowAudioProcessor()
     currentBaudRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_BAUD_RATE));
     currentLEDCount = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_COUNT));
     currentLEDOffset = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_OFFSET));
+    currentMappingMode = static_cast<int>(*parameters.getRawParameterValue(PARAM_MAPPING_MODE));
+    currentLEDsPerMetre = static_cast<int>(*parameters.getRawParameterValue(PARAM_LEDS_PER_METRE));
+    currentKeyWidths = parameters.state.getProperty(PARAM_KEY_WIDTHS, "").toString();
+    currentSegmentTable = parameters.state.getProperty(PARAM_SEGMENTS, "").toString();
+    currentRoutingTable = parameters.state.getProperty(PARAM_ROUTING, "").toString();
+    
+    // Compile the initial segment map and take it over right away (the audio thread is not running yet)
+    rebuildSegmentMap();
+    segmentBuffer.update();
+    
+    currentColourOrder = static_cast<int>(*parameters.getRawParameterValue(PARAM_COLOUR_ORDER));
+    compositor.setColourOrder(static_cast<ColourOrder>(currentColourOrder));
+    
+    // The feedback pattern replaces whatever is below it
+    layerStack.getLayer(LayerId::Feedback).blendMode = BlendMode::Alpha;
     
-    // Initialize protocol sender with the saved (or default) protocol
-    createProtocolSender(currentProtocol);
+    // Build the initial routing and colour tables and rebuild them whenever a palette parameter changes
+    for (auto* paletteParam : { PARAM_COLOR_HUE, PARAM_COLOR_SAT, PARAM_COLOR_VAL, PARAM_PALETTE_MODE, PARAM_PALETTE_HUE_RANGE })
+        parameters.addParameterListener(paletteParam, this);
+    rebuildRouting();
+    
+    // Same for the gamma/calibration tables - far too slow to rebuild on the audio thread
+    for (auto* transferParam : { PARAM_GAMMA, PARAM_CALIBRATION_RED, PARAM_CALIBRATION_GREEN, PARAM_CALIBRATION_BLUE })
+        parameters.addParameterListener(transferParam, this);
+    rebuildOutputTransfer();
+    transferBuffer.update();
+    compositor.setTransferTable(transferBuffer.getReadBuffer());
+    
+    // Hand the saved (or default) protocol to the output thread - memory only, nothing is opened yet.
+    // The thread, and with it every socket and serial port, starts on the first prepareToPlay,
+    // so plugin scans and session loads never touch the network
+    publishOutputConfig(true);
 }
 
 KeyGlowAudioProcessor::~KeyGlowAudioProcessor()
 {
+    for (auto* paletteParam : { PARAM_COLOR_HUE, PARAM_COLOR_SAT, PARAM_COLOR_VAL, PARAM_PALETTE_MODE, PARAM_PALETTE_HUE_RANGE })
+        parameters.removeParameterListener(paletteParam, this);
+    for (auto* transferParam : { PARAM_GAMMA, PARAM_CALIBRATION_RED, PARAM_CALIBRATION_GREEN, PARAM_CALIBRATION_BLUE })
+        parameters.removeParameterListener(transferParam, this);
+    cancelPendingUpdate();
+    
+    outputScheduler.stopThread(2000);
 }
 
 //==============================================================================
@@ -139,11 +252,40 @@ void KeyGlowAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
 {
     this->sampleRate = sampleRate;
     updateCounter = 0;
-    updateInterval = static_cast<int>(sampleRate / TARGET_UPDATE_HZ);
+    currentFrameRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_FRAME_RATE));
+    updateInterval = static_cast<int>(sampleRate / currentFrameRate);
+    
+    // Allocate the framebuffer here, never on the audio thread
+    compositor.prepare(MAX_LEDS);
+    layerStack.prepare(MAX_LEDS);
+    spreadStage.prepare(MAX_LEDS);
+    particleEngine.prepare(MAX_PARTICLES);
+    matrixCanvas.prepare(MatrixTarget::MAX_PIXELS);
+    
+    // The analysis tables depend on the sample rate - rebuild them with the thread stopped
+    audioAnalyser.stopThread(1000);
+    audioAnalyser.prepare(sampleRate);
+    audioAnalyser.startThread();
+    
+    // An offline render must not reach the strip, not even before its first block: suspend
+    // before the output thread starts, so it creates no senders. The first offline block opens the show file
+    renderingOffline = false;
+    outputScheduler.setSuspended(isNonRealtime());
+    
+    // First prepare: start the output thread, which creates the senders off this thread
+    if (!outputScheduler.isThreadRunning())
+        outputScheduler.startThread();
 }
 
 void KeyGlowAudioProcessor::releaseResources()
 {
+    audioAnalyser.stopThread(1000);
+    
+    // End of a bounce (if any) - finish the show file and resume live output,
+    // unless the processor is still offline (the command-line renderer never goes live)
+    bounceWriter.close();
+    renderingOffline = isNonRealtime();
+    outputScheduler.setSuspended(renderingOffline);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -159,6 +301,12 @@ bool KeyGlowAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+   #else
+    // Optional sidechain for the audio-reactive layer
+    if (! layouts.getMainInputChannelSet().isDisabled()
+     && layouts.getMainInputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
    #endif
     return true;
   #endif
@@ -169,9 +317,59 @@ void KeyGlowAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
 {
     juce::ScopedNoDenormals noDenormals;
     
+    // Offline render (bounce): runs faster than real time, so nothing may go out live.
+    // Frames are recorded with their sample times instead if a show file is set
+    const bool offline = isNonRealtime();
+    if (offline != renderingOffline)
+    {
+        renderingOffline = offline;
+        outputScheduler.setSuspended(offline);
+        
+        if (offline)
+        {
+            juce::String bouncePath = parameters.state.getProperty(PARAM_BOUNCE_FILE, "").toString();
+            bounceStartSample = sampleClock;
+            if (juce::File::isAbsolutePath(bouncePath))
+                bounceWriter.open(juce::File(bouncePath), sampleRate);
+        }
+        else
+        {
+            bounceWriter.close();
+        }
+    }
+    
+    // A frame that found the delay line full goes out as soon as there is room
+    if (!renderingOffline)
+        outputScheduler.flushHeldFrame();
+    
     // Update parameters
     updateParameters();
     
+    // Take one transport snapshot per block - frames extrapolate the musical position from it
+    // (hosts that report no PPQ keep the position running from the previous snapshot)
+    const double extrapolatedPpq = transport.getPpqAt(sampleClock);
+    transport.sampleTime = sampleClock;
+    transport.sampleRate = sampleRate;
+    transport.ppqPosition = extrapolatedPpq;
+    frameDeadline = sampleClock;
+    
+    // The audio of this block is heard one host buffer (auto delay) plus the configured latency from now
+    blockStartSample = sampleClock;
+    blockStartMs = juce::Time::getMillisecondCounterHiRes();
+    outputLatencyMs = *parameters.getRawParameterValue(PARAM_LIGHT_DELAY);
+    if (*parameters.getRawParameterValue(PARAM_AUTO_DELAY) > 0.5f)
+        outputLatencyMs += static_cast<double>(buffer.getNumSamples()) * 1000.0 / sampleRate;
+    
+    if (auto* playHead = getPlayHead())
+    {
+        if (auto position = playHead->getPosition())
+        {
+            transport.isPlaying = position->getIsPlaying();
+            transport.bpm = position->getBpm().orFallback(transport.bpm);
+            transport.ppqPosition = position->getPpqPosition().orFallback(extrapolatedPpq);
+        }
+    }
+    
     // Process MIDI messages
     if (midiMessages.getNumEvents() > 0)
     {
@@ -206,15 +404,21 @@ void KeyGlowAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
         sendChangeMessage();
     }
     
-    // Send to LEDs periodically when there are active notes (to reflect ADSR changes)
-    // This allows ADSR envelope changes to be visible in real-time
-    // Only send when notes are active to avoid interference with multiple plugin instances
-    if (activeNotes.size() > 0)
+    // Sample clock for frame timing (particle integration)
+    sampleClock += numSamples;
+    
+    // Send to LEDs periodically when there are active notes, particles or a piano roll still scrolling
+    // (to reflect ADSR changes). This allows ADSR envelope changes to be visible in real-time
+    // Only send when something is lit to avoid interference with multiple plugin instances
+    const bool effectLit = audioAnalyser.isActive() || (currentBeatEffect != BeatEffect::Off && transport.isPlaying);
+    if (activeNotes.size() > 0 || particleEngine.getNumLive() > 0 || matrixCanvas.isScrolling() || effectLit)
     {
         updateCounter += numSamples;
         if (updateCounter >= updateInterval)
         {
-            updateArtNetOutput();
+            // The frame was due where the counter crossed the interval, somewhere inside this block
+            frameDeadline = sampleClock - (updateCounter - updateInterval);
+            updateArtNetOutput(true);
             updateCounter = 0;
         }
     }
@@ -222,7 +426,17 @@ void KeyGlowAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
     {
         // Reset counter when no notes are active
         updateCounter = 0;
+        
+        // An effect just stopped (transport stopped, input silent or effect switched off): one more
+        // frame without it, otherwise its last frame stays on the strip
+        if (effectWasLit)
+            updateArtNetOutput(false);
     }
+    effectWasLit = effectLit;
+    
+    // Audio-reactive mode: hand the input to the analysis thread (a copy into a ring, nothing more)
+    if (getTotalNumInputChannels() > 0)
+        audioAnalyser.pushSamples(getBusBuffer(buffer, true, 0));
     
     // Clear buffer (this is a MIDI effect, no audio processing)
     buffer.clear();
@@ -261,74 +475,117 @@ void KeyGlowAudioProcessor::setStateInformation (const void* data, int sizeInByt
 //==============================================================================
 void KeyGlowAudioProcessor::updateParameters()
 {
-    // Update protocol FIRST - ensures the correct sender is active
-    // before any visual feedback or data is sent
+    // Any change to the mapping or output destinations recompiles the segment map (on the message thread)
+    bool mappingChanged = false;
+    
+    // Update protocol (the output thread recreates the sender once the new segment map is published)
     int newProtocol = static_cast<int>(*parameters.getRawParameterValue(PARAM_PROTOCOL));
     if (newProtocol != currentProtocol)
     {
         DBG("PluginProcessor::updateParameters - Protocol changed from " + juce::String(currentProtocol) + " to " + juce::String(newProtocol));
         currentProtocol = newProtocol;
-        createProtocolSender(currentProtocol);
+        mappingChanged = true;
     }
     
-    // Update universe (for network protocols)
-    int newUniverse = static_cast<int>(*parameters.getRawParameterValue(PARAM_UNIVERSE));
-    if (newUniverse != currentUniverse)
+    // Update colour order (changes the number of channels per LED for RGBW, and with it where
+    // long strips are split across universes)
+    int newColourOrder = static_cast<int>(*parameters.getRawParameterValue(PARAM_COLOUR_ORDER));
+    if (newColourOrder != currentColourOrder)
     {
-        currentUniverse = newUniverse;
-        if (dmxSender && currentProtocol != 2)  // Not Adalight
-        {
-            dmxSender->setUniverse(currentUniverse);
-        }
+        currentColourOrder = newColourOrder;
+        compositor.setColourOrder(static_cast<ColourOrder>(currentColourOrder));
+        mappingChanged = true;
     }
     
-    // Update baud rate (for Adalight)
-    int newBaudRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_BAUD_RATE));
-    if (newBaudRate != currentBaudRate)
+    // Output transfer: pick up rebuilt gamma/calibration tables; brightness is a plain scale, free to automate
+    if (transferBuffer.update())
+        compositor.setTransferTable(transferBuffer.getReadBuffer());
+    compositor.setBrightness(*parameters.getRawParameterValue(PARAM_BRIGHTNESS));
+    compositor.setDithering(*parameters.getRawParameterValue(PARAM_DITHERING) > 0.5f);
+    compositor.setPowerLimit(*parameters.getRawParameterValue(PARAM_POWER_LIMIT),
+                             *parameters.getRawParameterValue(PARAM_MILLIAMPS_PER_CHANNEL));
+    
+    // Update glow (kernel coefficients are only recomputed when the radius changes)
+    spreadStage.setShape(static_cast<SpreadMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_GLOW_MODE))),
+                         *parameters.getRawParameterValue(PARAM_GLOW_RADIUS),
+                         *parameters.getRawParameterValue(PARAM_GLOW_AMOUNT));
+    currentGlowVelocity = *parameters.getRawParameterValue(PARAM_GLOW_VELOCITY);
+    
+    // Update controller modulation
+    const int brightnessCC = static_cast<int>(*parameters.getRawParameterValue(PARAM_BRIGHTNESS_CC));
+    if (brightnessCC != currentBrightnessCC)
     {
-        currentBaudRate = newBaudRate;
-        if (dmxSender && currentProtocol == 2)  // Adalight only
-        {
-            dmxSender->setUniverse(currentBaudRate);  // For Adalight, setUniverse() configures baud rate
-        }
+        currentBrightnessCC = brightnessCC;
+        modulation.resetBrightness();
     }
     
-    // Update WLED IP (from ValueTree property) - for network protocols
-    juce::String newIP = parameters.state.getProperty(PARAM_WLED_IP, "239.255.0.1").toString();
-    if (newIP != currentWLEDIP)
+    const int hueCC = static_cast<int>(*parameters.getRawParameterValue(PARAM_HUE_CC));
+    if (hueCC != currentHueCC)
     {
-        currentWLEDIP = newIP;
-        if (dmxSender && currentProtocol != 2) // Not Adalight
-        {
-            dmxSender->setTargetIP(currentWLEDIP);
-        }
+        currentHueCC = hueCC;
+        modulation.resetTimbre();
+    }
+    
+    currentHueModDepth = *parameters.getRawParameterValue(PARAM_HUE_MOD_DEPTH);
+    currentPressureDepth = *parameters.getRawParameterValue(PARAM_PRESSURE_DEPTH);
+    
+    // Update the audio-reactive layer (analysis runs at the LED frame rate)
+    currentAudioMode = static_cast<AudioReactiveMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_AUDIO_MODE)));
+    audioAnalyser.setEnabled(currentAudioMode != AudioReactiveMode::Off);
+    audioAnalyser.setFrameRate(currentFrameRate);
+    audioAnalyser.setSensitivity(*parameters.getRawParameterValue(PARAM_AUDIO_SENSITIVITY));
+    layerStack.getLayer(LayerId::Audio).opacity = *parameters.getRawParameterValue(PARAM_AUDIO_LEVEL);
+    
+    // Update the tempo-synced effect
+    currentBeatEffect = static_cast<BeatEffect>(static_cast<int>(*parameters.getRawParameterValue(PARAM_BEAT_EFFECT)));
+    currentBeatCycle = BeatEffectRenderer::getCycleLength(static_cast<int>(*parameters.getRawParameterValue(PARAM_BEAT_DIVISION)));
+    currentBeatLevel = *parameters.getRawParameterValue(PARAM_BEAT_LEVEL);
+    
+    // Update note-triggered effects
+    particleEngine.setEffect(static_cast<ParticleEffect>(static_cast<int>(*parameters.getRawParameterValue(PARAM_EFFECT_MODE))),
+                             *parameters.getRawParameterValue(PARAM_EFFECT_SPEED),
+                             *parameters.getRawParameterValue(PARAM_EFFECT_LIFETIME));
+    
+    Layer& particleLayer = layerStack.getLayer(LayerId::Particles);
+    particleLayer.blendMode = static_cast<BlendMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_EFFECT_BLEND)));
+    particleLayer.opacity = *parameters.getRawParameterValue(PARAM_EFFECT_OPACITY);
+    
+    // Update output frame rate
+    int newFrameRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_FRAME_RATE));
+    if (newFrameRate != currentFrameRate)
+    {
+        currentFrameRate = newFrameRate;
+        updateInterval = static_cast<int>(sampleRate / currentFrameRate);
     }
     
-    // Update Serial Port (from ValueTree property) - for Adalight
+    // Update universe (network protocols), baud rate (Adalight), WLED IP and serial port (ValueTree properties)
+    int newUniverse = static_cast<int>(*parameters.getRawParameterValue(PARAM_UNIVERSE));
+    int newBaudRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_BAUD_RATE));
+    juce::String newIP = parameters.state.getProperty(PARAM_WLED_IP, "239.255.0.1").toString();
     juce::String newSerialPort = parameters.state.getProperty(PARAM_SERIAL_PORT, "").toString();
-    if (newSerialPort != currentSerialPort)
+    if (newUniverse != currentUniverse || newBaudRate != currentBaudRate || newIP != currentWLEDIP || newSerialPort != currentSerialPort)
     {
-        DBG("PluginProcessor::updateParameters - Serial port changed from '" + currentSerialPort + "' to '" + newSerialPort + "'");
-        currentSerialPort = newSerialPort;
-        if (dmxSender && currentProtocol == 2) // Adalight
+        if (newSerialPort != currentSerialPort)
         {
-            DBG("  Calling setTargetIP with new serial port: '" + currentSerialPort + "'");
-            dmxSender->setTargetIP(currentSerialPort); // setTargetIP is used for serial port name in Adalight
+            DBG("PluginProcessor::updateParameters - Serial port changed from '" + currentSerialPort + "' to '" + newSerialPort + "'");
         }
+        
+        currentUniverse = newUniverse;
+        currentBaudRate = newBaudRate;
+        currentWLEDIP = newIP;
+        currentSerialPort = newSerialPort;
+        mappingChanged = true;
     }
     
     // Update LED offset
     int newLEDOffset = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_OFFSET));
     if (newLEDOffset != currentLEDOffset)
     {
-        int oldOffset = currentLEDOffset;
         currentLEDOffset = newLEDOffset;
+        mappingChanged = true;
         
-        // Send visual feedback when offset changes to show the new range
-        // Calculate the range we need to cover (old and new positions)
-        int patternEnd = juce::jmax(oldOffset + currentLEDCount - 1, newLEDOffset + currentLEDCount - 1);
-        int rangeLEDCount = patternEnd + 1;
-        sendVisualFeedbackWithRange(rangeLEDCount);
+        // Show the new range once the recompiled segment map arrives
+        feedbackPending = true;
     }
     
     // Update note range
@@ -346,27 +603,71 @@ void KeyGlowAudioProcessor::updateParameters()
         }
         currentLowestNote = newLowestNote;
         currentHighestNote = newHighestNote;
+        mappingChanged = true;
     }
     
     // Update LED count
     int newLEDCount = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_COUNT));
     if (newLEDCount != currentLEDCount)
     {
-        int oldLEDCount = currentLEDCount;
         currentLEDCount = newLEDCount;
-        
-        // Send visual feedback when LED count changes
-        if (previousLEDCount != currentLEDCount)
-        {
-            // Calculate the range we need to cover (old and new positions)
-            int oldPatternEnd = currentLEDOffset + oldLEDCount - 1;
-            int newPatternEnd = currentLEDOffset + newLEDCount - 1;
-            int rangeLEDCount = juce::jmax(oldPatternEnd + 1, newPatternEnd + 1);
-            
-            // Always use sendVisualFeedbackWithRange to ensure proper cleanup
-            sendVisualFeedbackWithRange(rangeLEDCount);
-            previousLEDCount = currentLEDCount;
-        }
+        mappingChanged = true;
+        feedbackPending = true;
+    }
+    
+    // Update mapping mode, strip density and custom key widths
+    int newMappingMode = static_cast<int>(*parameters.getRawParameterValue(PARAM_MAPPING_MODE));
+    int newLEDsPerMetre = static_cast<int>(*parameters.getRawParameterValue(PARAM_LEDS_PER_METRE));
+    juce::String newKeyWidths = parameters.state.getProperty(PARAM_KEY_WIDTHS, "").toString();
+    juce::String newSegmentTable = parameters.state.getProperty(PARAM_SEGMENTS, "").toString();
+    if (newMappingMode != currentMappingMode || newLEDsPerMetre != currentLEDsPerMetre || newKeyWidths != currentKeyWidths
+        || newSegmentTable != currentSegmentTable)
+    {
+        currentMappingMode = newMappingMode;
+        currentLEDsPerMetre = newLEDsPerMetre;
+        currentKeyWidths = newKeyWidths;
+        currentSegmentTable = newSegmentTable;
+        mappingChanged = true;
+    }
+    
+    if (mappingChanged)
+    {
+        segmentMapDirty = true;
+        triggerAsyncUpdate();
+    }
+    
+    // Update the MIDI channel routing table
+    juce::String newRoutingTable = parameters.state.getProperty(PARAM_ROUTING, "").toString();
+    if (newRoutingTable != currentRoutingTable)
+    {
+        currentRoutingTable = newRoutingTable;
+        routingDirty = true;
+        triggerAsyncUpdate();
+    }
+    
+    // Start or stop show file recording / playback
+    int newShowMode = static_cast<int>(*parameters.getRawParameterValue(PARAM_SHOW_MODE));
+    juce::String newShowFile = parameters.state.getProperty(PARAM_SHOW_FILE, "").toString();
+    if (newShowMode != currentShowMode || newShowFile != currentShowFile)
+    {
+        currentShowMode = newShowMode;
+        currentShowFile = newShowFile;
+        showDirty = true;
+        triggerAsyncUpdate();
+    }
+    
+    // Pick up a recompiled segment map (held notes follow it, spans are looked up per frame)
+    const int previousTotalPixels = segmentBuffer.getReadBuffer().totalPixels;
+    const bool segmentsUpdated = segmentBuffer.update();
+    
+    // Hand sender, transfer, layout and idle animation settings to the output thread (only when changed)
+    publishOutputConfig();
+    
+    // The configuration pattern follows the new map, so it goes out after the senders were updated
+    if (segmentsUpdated && feedbackPending)
+    {
+        feedbackPending = false;
+        sendVisualFeedback(previousTotalPixels);
     }
     
     // Update ADSR parameters
@@ -375,11 +676,9 @@ void KeyGlowAudioProcessor::updateParameters()
     sustainLevel = *parameters.getRawParameterValue(PARAM_SUSTAIN);
     releaseTime = *parameters.getRawParameterValue(PARAM_RELEASE);
     
-    // Update color
-    float hue = *parameters.getRawParameterValue(PARAM_COLOR_HUE);
-    float sat = *parameters.getRawParameterValue(PARAM_COLOR_SAT);
-    float val = *parameters.getRawParameterValue(PARAM_COLOR_VAL);
-    currentColor = juce::Colour::fromHSV(hue, sat, val, 1.0f);
+    // Pick up a rebuilt routing/colour table (only when the palette or routing changed)
+    const bool routingChanged = routingBuffer.update();
+    const auto& routing = routingBuffer.getReadBuffer();
     
     // Update envelopes for active notes
     for (auto& note : activeNotes)
@@ -388,7 +687,25 @@ void KeyGlowAudioProcessor::updateParameters()
         note.envelope.setDecay(decayTime);
         note.envelope.setSustain(sustainLevel);
         note.envelope.setRelease(releaseTime);
-        note.color = currentColor;
+        
+        // Held notes follow live palette and routing changes
+        if (routingChanged)
+        {
+            note.color = routing.lookup(note.midiNote, note.velocity, note.midiChannel);
+            note.segmentMask = routing.getRoute(note.midiChannel).segmentMask;
+        }
+    }
+    
+    // Spectrum bands take the plugin palette colour of their centre note
+    if (routingChanged)
+    {
+        for (int band = 0; band < AudioAnalysisFrame::NUM_BANDS; band++)
+        {
+            const juce::Colour colour = routing.palettes[0].lookup(AudioAnalyser::getBandNote(band), 1.0f, 1);
+            audioBandColours[band][0] = colour.getFloatRed();
+            audioBandColours[band][1] = colour.getFloatGreen();
+            audioBandColours[band][2] = colour.getFloatBlue();
+        }
     }
 }
 
@@ -422,25 +739,30 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
                 continue; // Don't process as a regular note
             }
             
-            // Check if note is in range
-            if (midiNote < currentLowestNote || midiNote > currentHighestNote)
+            // Check if note is in range of any segment its channel is routed to
+            int midiChannel = message.getChannel();
+            const ChannelRouting& routing = routingBuffer.getReadBuffer();
+            const juce::uint32 segmentMask = routing.getRoute(midiChannel).segmentMask;
+            const SegmentMap& segments = segmentBuffer.getReadBuffer();
+            if (!segments.isMapped(midiNote, segmentMask))
             {
                 continue;
             }
             
             float velocity = message.getFloatVelocity();
-            int ledIndex = midiNoteToLEDIndex(midiNote);
+            const juce::Colour noteColour = routing.lookup(midiNote, velocity, midiChannel);
+            modulation.resetNote(midiChannel, midiNote);
             
-            // Check if note is already active
+            // Check if note is already active on this channel
             bool found = false;
             for (auto& note : activeNotes)
             {
-                if (note.midiNote == midiNote)
+                if (note.midiNote == midiNote && note.midiChannel == midiChannel)
                 {
                     // Re-trigger the note
                     note.velocity = velocity;
-                    note.ledIndex = ledIndex;
-                    note.color = currentColor;
+                    note.segmentMask = segmentMask;
+                    note.color = noteColour;
                     note.isSustained = false; // Reset sustain state
                     note.envelope.setAttack(attackTime);
                     note.envelope.setDecay(decayTime);
@@ -460,9 +782,10 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
                 int numBefore = activeNotes.size();
                 ActiveNote newNote;
                 newNote.midiNote = midiNote;
-                newNote.ledIndex = ledIndex;
+                newNote.midiChannel = midiChannel;
+                newNote.segmentMask = segmentMask;
                 newNote.velocity = velocity;
-                newNote.color = currentColor;
+                newNote.color = noteColour;
                 newNote.currentEnvelopeLevel = 0.0f;
                 newNote.isSustained = false;
                 newNote.envelope.setAttack(attackTime);
@@ -480,18 +803,40 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
                     sendChangeMessage();
                 }
             }
+            
+            // Spawn note-triggered particles from the centre of each of the note's spans
+            if (particleEngine.isEnabled())
+            {
+                // With no live particles the clock may be stale (no frames while idle);
+                // restart it so the new particles' first step isn't the whole idle time
+                if (particleEngine.getNumLive() == 0)
+                    lastParticleUpdateClock = sampleClock;
+                
+                for (auto* span = segments.begin(midiNote); span != segments.end(midiNote); ++span)
+                {
+                    if ((span->segmentBit & segmentMask) == 0)
+                        continue;
+                    
+                    float centre = static_cast<float>(span->firstPixel) + static_cast<float>(span->numPixels - 1) * 0.5f;
+                    particleEngine.trigger(centre,
+                                           juce::jmap(span->paletteMix, span->fixedRed, noteColour.getFloatRed()) * velocity,
+                                           juce::jmap(span->paletteMix, span->fixedGreen, noteColour.getFloatGreen()) * velocity,
+                                           juce::jmap(span->paletteMix, span->fixedBlue, noteColour.getFloatBlue()) * velocity);
+                }
+            }
         }
                 else if (message.isNoteOff())
         {
             int midiNote = message.getNoteNumber();
+            int midiChannel = message.getChannel();
             
             // Check if note is in range (or was previously active)
             // We still process note-off even if outside range to clean up any active notes
             for (auto& note : activeNotes)
             {
-                if (note.midiNote == midiNote)
+                if (note.midiNote == midiNote && note.midiChannel == midiChannel)
                 {
-                    if (sustainPedalActive)
+                    if (sustainPedalActive[midiChannel - 1])
                     {
                         // Sustain pedal is active - hold the note in sustain phase
                         note.isSustained = true;
@@ -512,17 +857,18 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
         else if (message.isControllerOfType(64)) // Sustain pedal (CC 64)
         {
             bool newSustainState = message.getControllerValue() >= 64;
+            int midiChannel = message.getChannel();
             
-            if (newSustainState != sustainPedalActive)
+            if (newSustainState != sustainPedalActive[midiChannel - 1])
             {
-                sustainPedalActive = newSustainState;
+                sustainPedalActive[midiChannel - 1] = newSustainState;
                 
-                if (!sustainPedalActive)
+                if (!newSustainState)
                 {
-                    // Sustain pedal released - release all sustained notes
+                    // Sustain pedal released - release the sustained notes of this channel
                     for (auto& note : activeNotes)
                     {
-                        if (note.isSustained)
+                        if (note.isSustained && note.midiChannel == midiChannel)
                         {
                             note.envelope.noteOff();
                             note.isSustained = false;
@@ -534,6 +880,31 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
                 notesChanged = true;
             }
         }
+        // Controllers only store their latest value - the voices pick them up once per frame
+        // in updateArtNetOutput(), so they don't trigger a send of their own
+        else if (message.isChannelPressure())
+        {
+            modulation.setChannelPressure(message.getChannel(), message.getChannelPressureValue() / 127.0f);
+        }
+        else if (message.isAftertouch())
+        {
+            modulation.setPolyPressure(message.getChannel(), message.getNoteNumber(), message.getAfterTouchValue() / 127.0f);
+        }
+        else if (message.isPitchWheel())
+        {
+            modulation.setPitchBend(message.getChannel(), static_cast<float>(message.getPitchWheelValue() - 8192) / 8192.0f);
+        }
+        else if (message.isController())
+        {
+            int controller = message.getControllerNumber();
+            float value = message.getControllerValue() / 127.0f;
+            
+            // CC 0 (bank select) is the parameters' "Off" value and must never match
+            if (currentBrightnessCC > 0 && controller == currentBrightnessCC)
+                modulation.setBrightness(value);
+            else if (currentHueCC > 0 && controller == currentHueCC)
+                modulation.setTimbre(message.getChannel(), value);
+        }
     }
     
     // Note: inactive note removal is handled in processBlock() after envelope updates,
@@ -545,177 +916,388 @@ void KeyGlowAudioProcessor::processMidiMessages(juce::MidiBuffer& midiMessages)
     // Event-driven sending was designed for network protocols where bandwidth isn't an issue.
     if (notesChanged && currentProtocol != 2)
     {
-        updateArtNetOutput();
+        updateArtNetOutput(false);
     }
 }
 
-void KeyGlowAudioProcessor::updateArtNetOutput()
+void KeyGlowAudioProcessor::updateArtNetOutput(bool periodicFrame)
 {
-    // Calculate the actual range we need to cover
-    // Packet covers LEDs from 0 to (offset + count - 1)
-    int packetLEDCount = currentLEDOffset + currentLEDCount;
-    const int numChannels = packetLEDCount * 3; // RGB per LED
+    // The segment frame covers every destination, each from LED 0 to the end of its last segment
+    const SegmentMap& segments = segmentBuffer.getReadBuffer();
+    int packetLEDCount = segments.totalPixels;
     
-    // Clamp to pre-allocated buffer size
-    if (numChannels > MAX_DMX_BUFFER_SIZE || numChannels == 0)
+    // Clamp to pre-allocated framebuffer size
+    if (packetLEDCount > layerStack.getMaxPixels() || packetLEDCount == 0)
         return;
     
-    // Use pre-allocated buffer (no heap allocation on audio thread)
-    // Initialize all channels to zero (ensures LEDs beyond the pattern are off)
-    memset(dmxBuffer, 0, numChannels);
+    // Layers only hold what is drawn this frame - the stack composites over black,
+    // so LEDs outside the drawn ranges are off
+    Layer& notesLayer = layerStack.getLayer(LayerId::Notes);
+    Layer& particleLayer = layerStack.getLayer(LayerId::Particles);
+    
+    const bool glowActive = spreadStage.isActive();
+    if (glowActive)
+        spreadStage.clear(packetLEDCount);
+    
+    // Apply the controller values that arrived since the last frame (last value wins)
+    for (auto& note : activeNotes)
+    {
+        float pressure = modulation.getPressure(note.midiChannel, note.midiNote) * currentPressureDepth;
+        note.intensity = juce::jmap(pressure, note.velocity, 1.0f) * modulation.getBrightness();
+        
+        float hueShift = modulation.getHueModulation(note.midiChannel) * currentHueModDepth;
+        note.renderColour = hueShift != 0.0f ? note.color.withRotatedHue(hueShift) : note.color;
+    }
     
-    // Set LED values based on active notes
+    // Blend active notes into the notes layer (additive, so notes sharing an LED mix)
+    // Each note renders its precompiled spans - one per segment it maps to, already clipped,
+    // reversed and coloured, so there is nothing left to decide here
     for (const auto& note : activeNotes)
     {
-        // Check if LED index is within the valid range (offset to offset + count)
-        int minLEDIndex = currentLEDOffset;
-        int maxLEDIndex = currentLEDOffset + currentLEDCount - 1;
+        if (!note.envelope.isActive())
+            continue;
+        
+        // Use the stored envelope level (updated in processBlock)
+        float brightness = note.currentEnvelopeLevel * note.intensity;
+        
+        // Harder keypresses bloom brighter, blended by the glow velocity setting
+        float glow = brightness * juce::jmap(currentGlowVelocity, 1.0f, note.velocity);
         
-        if (note.ledIndex >= minLEDIndex && note.ledIndex <= maxLEDIndex && note.envelope.isActive())
+        for (auto* span = segments.begin(note.midiNote); span != segments.end(note.midiNote); ++span)
         {
-            // Use the stored envelope level (updated in processBlock)
-            float brightness = note.currentEnvelopeLevel * note.velocity;
+            if ((span->segmentBit & note.segmentMask) == 0)
+                continue;
+            
+            float red = juce::jmap(span->paletteMix, span->fixedRed, note.renderColour.getFloatRed());
+            float green = juce::jmap(span->paletteMix, span->fixedGreen, note.renderColour.getFloatGreen());
+            float blue = juce::jmap(span->paletteMix, span->fixedBlue, note.renderColour.getFloatBlue());
             
-            // Get RGB values from color
-            uint8_t r = static_cast<uint8_t>(note.color.getRed() * brightness);
-            uint8_t g = static_cast<uint8_t>(note.color.getGreen() * brightness);
-            uint8_t b = static_cast<uint8_t>(note.color.getBlue() * brightness);
+            notesLayer.addSpan(span->firstPixel, span->numPixels, red * brightness, green * brightness, blue * brightness);
             
-            int channelIndex = note.ledIndex * 3;
-            if (channelIndex + 2 < numChannels)
+            if (glowActive)
+                spreadStage.addImpulse(span->firstPixel, span->numPixels, red * glow, green * glow, blue * glow);
+        }
+    }
+    
+    // Piano roll: one new canvas row per frame period from the held notes, then a single gather into wire order.
+    // Event frames redraw the newest row, so the scroll speed follows time, not MIDI density
+    const MatrixTarget& matrix = segments.matrix;
+    if (matrix.isEnabled())
+    {
+        if (matrix.width != matrixCanvas.getWidth() || matrix.height != matrixCanvas.getHeight())
+            matrixCanvas.setSize(matrix.width, matrix.height);
+        
+        float* row = matrixCanvas.beginRow(periodicFrame);
+        bool rowLit = false;
+        
+        for (const auto& note : activeNotes)
+        {
+            const PixelRange& columns = matrix.noteColumns[juce::jlimit(0, 127, note.midiNote)];
+            float brightness = note.currentEnvelopeLevel * note.intensity;
+            if (columns.numPixels == 0 || brightness <= 0.0f || (matrix.segmentBit & note.segmentMask) == 0)
+                continue;
+            
+            float red = juce::jmap(matrix.paletteMix, matrix.fixedRed, note.renderColour.getFloatRed()) * brightness;
+            float green = juce::jmap(matrix.paletteMix, matrix.fixedGreen, note.renderColour.getFloatGreen()) * brightness;
+            float blue = juce::jmap(matrix.paletteMix, matrix.fixedBlue, note.renderColour.getFloatBlue()) * brightness;
+            
+            for (int column = columns.firstPixel; column < columns.firstPixel + columns.numPixels; column++)
             {
-                dmxBuffer[channelIndex] = r;
-                dmxBuffer[channelIndex + 1] = g;
-                dmxBuffer[channelIndex + 2] = b;
+                row[column * 3] += red;
+                row[column * 3 + 1] += green;
+                row[column * 3 + 2] += blue;
             }
+            rowLit = true;
         }
+        
+        matrixCanvas.commitRow(rowLit);
+        matrixCanvas.gather(notesLayer.getPixels() + matrix.firstPixel * 3, matrix.pixelMap, matrix.getNumPixels());
+        notesLayer.markDirty(matrix.firstPixel, matrix.getNumPixels());
     }
     
-    if (dmxSender)
+    // Spread all impulses in one pass per segment - cost depends on the strip length, not on the number of notes
+    // Glow stops at segment ends instead of bleeding into the next strip
+    if (glowActive)
     {
-        dmxSender->sendDMX(dmxBuffer, numChannels);
+        for (int s = 0; s < segments.numStripSegments; s++)
+        {
+            const PixelRange& range = segments.stripRanges[s];
+            spreadStage.process(notesLayer.getPixels(), range.firstPixel, range.numPixels);
+            notesLayer.markDirty(range.firstPixel, range.numPixels);
+        }
     }
-}
-
-int KeyGlowAudioProcessor::midiNoteToLEDIndex(int midiNote) const
-{
-    if (currentLEDCount == 0)
-        return 0;
     
-    // Clamp note to range
-    int clampedNote = juce::jlimit(currentLowestNote, currentHighestNote, midiNote);
+    // Audio-reactive layer: the bands stretched across each strip segment, onsets flash it all
+    // (left empty once the input is silent, so the trailing frame clears it)
+    if (currentAudioMode != AudioReactiveMode::Off && audioAnalyser.isActive())
+    {
+        auto& analysisFrames = audioAnalyser.getFrames();
+        analysisFrames.update();
+        const AudioAnalysisFrame& analysis = analysisFrames.getReadBuffer();
+        
+        const bool showSpectrum = currentAudioMode == AudioReactiveMode::Spectrum || currentAudioMode == AudioReactiveMode::Both;
+        const bool showFlash = currentAudioMode == AudioReactiveMode::Flash || currentAudioMode == AudioReactiveMode::Both;
+        const float flash = showFlash ? analysis.onset : 0.0f;
+        Layer& audioLayer = layerStack.getLayer(LayerId::Audio);
+        
+        for (int s = 0; s < segments.numStripSegments; s++)
+        {
+            const PixelRange& range = segments.stripRanges[s];
+            float* rgb = audioLayer.getPixels() + range.firstPixel * 3;
+            
+            for (int pixel = 0; pixel < range.numPixels; pixel++)
+            {
+                const int band = pixel * AudioAnalysisFrame::NUM_BANDS / range.numPixels;
+                const float level = juce::jmin(1.0f, (showSpectrum ? analysis.bands[band] : 0.0f) + flash);
+                rgb[pixel * 3] = audioBandColours[band][0] * level;
+                rgb[pixel * 3 + 1] = audioBandColours[band][1] * level;
+                rgb[pixel * 3 + 2] = audioBandColours[band][2] * level;
+            }
+            
+            audioLayer.markDirty(range.firstPixel, range.numPixels);
+        }
+    }
+    
+    // Tempo-synced effect at the musical position of this frame's deadline (no host call per frame)
+    if (currentBeatEffect != BeatEffect::Off && transport.isPlaying)
+    {
+        const double ppq = transport.getPpqAt(frameDeadline);
+        const float hue = *parameters.getRawParameterValue(PARAM_COLOR_HUE);
+        const float saturation = *parameters.getRawParameterValue(PARAM_COLOR_SAT);
+        Layer& beatLayer = layerStack.getLayer(LayerId::Beat);
+        
+        for (int s = 0; s < segments.numStripSegments; s++)
+        {
+            const PixelRange& range = segments.stripRanges[s];
+            BeatEffectRenderer::render(beatLayer.getPixels(), range.firstPixel, range.numPixels, currentBeatEffect,
+                                       ppq, currentBeatCycle, hue, saturation, currentBeatLevel);
+            beatLayer.markDirty(range.firstPixel, range.numPixels);
+        }
+    }
+    
+    // Advance particles by the time since the previous frame and splat them into their layer
+    float particleDelta = static_cast<float>(static_cast<double>(sampleClock - lastParticleUpdateClock) / sampleRate);
+    lastParticleUpdateClock = sampleClock;
+    particleEngine.update(particleDelta);
+    if (particleEngine.getNumLive() > 0)
+    {
+        for (int s = 0; s < segments.numStripSegments; s++)
+        {
+            const PixelRange& range = segments.stripRanges[s];
+            particleEngine.render(particleLayer.getPixels(), range.firstPixel, range.numPixels);
+            particleLayer.markDirty(range.firstPixel, range.numPixels);
+        }
+    }
     
-    // Map note range to LED range
-    int noteRange = currentHighestNote - currentLowestNote;
-    if (noteRange == 0)
-        return currentLEDOffset; // Single note maps to offset position
+    liveParticles = particleEngine.getNumLive();
+    particleOverflows = particleEngine.getOverflowCount();
+    particleFrameCostMs = static_cast<float>(particleEngine.getFrameCostMilliseconds());
     
-    // Calculate note position within the range (0 to noteRange)
-    int notePosition = clampedNote - currentLowestNote;
+    // Blend the layers in 16-bit fixed point, then apply gamma, brightness, calibration,
+    // colour order and power limiting while packing
+    const uint16_t* frame = layerStack.composite(packetLEDCount);
+    const int numChannels = compositor.render(frame, dmxBuffer, packetLEDCount);
     
-    // Map to LED index using integer division with proper rounding
-    // We want: position 0 → LED 0, position noteRange → LED (currentLEDCount - 1)
-    // Formula: (notePosition * (currentLEDCount - 1) + noteRange/2) / noteRange
-    // This ensures even distribution: divides note range into currentLEDCount equal segments
-    // The +noteRange/2 provides rounding to nearest LED
-    int ledIndex = (notePosition * (currentLEDCount - 1) + noteRange / 2) / noteRange;
+    estimatedMilliamps = compositor.getEstimatedMilliamps();
+    powerLimiterScale = compositor.getPowerLimiterScale();
     
-    // Clamp to valid LED range (safety check - should always be in range with correct formula)
-    ledIndex = juce::jlimit(0, currentLEDCount - 1, ledIndex);
+    // Sent when the frame's audio reaches the speakers, not when its MIDI reached us
+    const double dueMs = blockStartMs + static_cast<double>(frameDeadline - blockStartSample) * 1000.0 / sampleRate + outputLatencyMs;
     
-    // Add offset
-    return ledIndex + currentLEDOffset;
-}
-
-void KeyGlowAudioProcessor::sendVisualFeedback()
-{
-    // Send visual feedback pattern: bright edges, dim middle
-    int patternEnd = currentLEDOffset + currentLEDCount - 1;
-    int maxLEDs = patternEnd + 1;
-    if (dmxSender)
+    if (numChannels > 0)
     {
-        dmxSender->sendVisualFeedbackPattern(currentLEDCount, currentLEDOffset, maxLEDs);
+        if (renderingOffline)
+            bounceWriter.writeFrame(frameDeadline - bounceStartSample, dmxBuffer, numChannels);
+        else
+            outputScheduler.submitFrame(dmxBuffer, numChannels, dueMs);
     }
 }
 
-void KeyGlowAudioProcessor::sendVisualFeedbackWithRange(int rangeLEDCount)
+void KeyGlowAudioProcessor::sendVisualFeedback(int clearPixels)
 {
-    // Send visual feedback pattern for currentLEDCount at currentLEDOffset, 
-    // but in a packet covering rangeLEDCount
-    // This ensures LEDs beyond the pattern are explicitly set to zero (no jitter)
-    if (dmxSender)
+    // Configuration pattern on every compiled segment: bright edges, dim middle
+    // The packet also covers clearPixels (the previous map's length) so LEDs that left the map are set to zero
+    // The pattern goes through the layer stack and compositor so it respects colour order and calibration
+    const SegmentMap& segments = segmentBuffer.getReadBuffer();
+    const int rangeLEDCount = juce::jmin(juce::jmax(segments.totalPixels, clearPixels), layerStack.getMaxPixels());
+    if (rangeLEDCount <= 0)
+        return;
+    
+    Layer& feedbackLayer = layerStack.getLayer(LayerId::Feedback);
+    for (int s = 0; s < segments.numSegments; s++)
+    {
+        const PixelRange& range = segments.segmentRanges[s];
+        DMXSender::renderVisualFeedbackPattern(feedbackLayer.getPixels(), range.numPixels, range.firstPixel, rangeLEDCount);
+        feedbackLayer.markDirty(range.firstPixel, range.numPixels);
+    }
+    
+    const uint16_t* frame = layerStack.composite(rangeLEDCount);
+    const int numChannels = compositor.render(frame, dmxBuffer, rangeLEDCount);
+    if (numChannels > 0 && !renderingOffline)
     {
-        dmxSender->sendVisualFeedbackPattern(currentLEDCount, currentLEDOffset, rangeLEDCount);
+        outputScheduler.submitFrame(dmxBuffer, numChannels);
     }
 }
 
 //==============================================================================
-void KeyGlowAudioProcessor::createProtocolSender(int protocol)
+void KeyGlowAudioProcessor::publishOutputConfig(bool force)
 {
-    DBG("============================================");
-    DBG("PluginProcessor::createProtocolSender - PROTOCOL SWITCH to: " + juce::String(protocol));
-    DBG("  Active notes: " + juce::String(activeNotes.size()));
+    // Runs every block, but the output thread only sees a configuration that actually changed
+    OutputConfig config;
+    const SegmentMap& segments = segmentBuffer.getReadBuffer();
+    config.numDestinations = segments.numDestinations;
+    for (int d = 0; d < segments.numDestinations; d++)
+        config.destinations[d] = segments.destinations[d];
     
-    // Destroy existing sender
-    dmxSender.reset();
-    DBG("  Old sender destroyed");
+    config.keepAliveMs = static_cast<int>(*parameters.getRawParameterValue(PARAM_KEEP_ALIVE));
     
-    // Create new sender based on protocol
-    if (protocol == 0)
-    {
-        // Art-Net
-        dmxSender = std::make_unique<ArtNetSender>();
-        DBG("  Created ArtNetSender");
-    }
-    else if (protocol == 1)
+    config.colourOrder = static_cast<ColourOrder>(currentColourOrder);
+    config.brightness = *parameters.getRawParameterValue(PARAM_BRIGHTNESS);
+    config.gamma = *parameters.getRawParameterValue(PARAM_GAMMA);
+    config.gains[0] = *parameters.getRawParameterValue(PARAM_CALIBRATION_RED);
+    config.gains[1] = *parameters.getRawParameterValue(PARAM_CALIBRATION_GREEN);
+    config.gains[2] = *parameters.getRawParameterValue(PARAM_CALIBRATION_BLUE);
+    config.dithering = *parameters.getRawParameterValue(PARAM_DITHERING) > 0.5f;
+    config.powerLimit = *parameters.getRawParameterValue(PARAM_POWER_LIMIT);
+    config.milliampsPerChannel = *parameters.getRawParameterValue(PARAM_MILLIAMPS_PER_CHANNEL);
+    
+    config.numSegments = segments.numSegments;
+    for (int s = 0; s < segments.numSegments; s++)
+        config.segmentRanges[s] = segments.segmentRanges[s];
+    
+    // The idle animation uses the base colour
+    config.ambient.mode = static_cast<AmbientMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_AMBIENT_MODE)));
+    config.ambient.brightness = *parameters.getRawParameterValue(PARAM_AMBIENT_BRIGHTNESS);
+    config.ambient.speed = *parameters.getRawParameterValue(PARAM_AMBIENT_SPEED);
+    config.ambient.hue = *parameters.getRawParameterValue(PARAM_COLOR_HUE);
+    config.ambient.saturation = *parameters.getRawParameterValue(PARAM_COLOR_SAT);
+    config.ambient.masterBrightness = config.brightness;
+    config.ambientFrameRate = static_cast<int>(*parameters.getRawParameterValue(PARAM_AMBIENT_FRAME_RATE));
+    
+    if (force || config != outputConfig)
     {
-        // E1.31 (sACN)
-        dmxSender = std::make_unique<E131Sender>();
-        DBG("  Created E131Sender");
+        outputConfig = config;
+        outputScheduler.setConfig(outputConfig);
     }
-    else if (protocol == 2)
+}
+
+void KeyGlowAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    // May be called on the audio thread (automation) - the tables are rebuilt on the message thread
+    juce::ignoreUnused(newValue);
+    if (parameterID == PARAM_GAMMA || parameterID == PARAM_CALIBRATION_RED
+        || parameterID == PARAM_CALIBRATION_GREEN || parameterID == PARAM_CALIBRATION_BLUE)
+        transferDirty = true;
+    else
+        routingDirty = true;
+    
+    triggerAsyncUpdate();
+}
+
+void KeyGlowAudioProcessor::handleAsyncUpdate()
+{
+    rebuildPendingTables();
+}
+
+void KeyGlowAudioProcessor::rebuildPendingTables()
+{
+    // Whoever calls this does the work, so the message thread has nothing left to do
+    cancelPendingUpdate();
+    
+    // Routes refer to segments by name, so a new segment table rebuilds the routing as well
+    const bool segmentsChanged = segmentMapDirty.exchange(false);
+    if (segmentsChanged)
+        rebuildSegmentMap();
+    
+    if (routingDirty.exchange(false) || segmentsChanged)
+        rebuildRouting();
+    
+    if (showDirty.exchange(false))
+        applyShowMode();
+    
+    if (transferDirty.exchange(false))
+        rebuildOutputTransfer();
+}
+
+void KeyGlowAudioProcessor::rebuildOutputTransfer()
+{
+    // Message thread (or a tool's render thread) and the constructor - the audio thread picks the table up in updateParameters()
+    transferBuffer.getWriteBuffer().build(*parameters.getRawParameterValue(PARAM_GAMMA),
+                                          *parameters.getRawParameterValue(PARAM_CALIBRATION_RED),
+                                          *parameters.getRawParameterValue(PARAM_CALIBRATION_GREEN),
+                                          *parameters.getRawParameterValue(PARAM_CALIBRATION_BLUE));
+    transferBuffer.publish();
+}
+
+void KeyGlowAudioProcessor::rebuildSegmentMap()
+{
+    // Message thread (or a tool's render thread between blocks) and the constructor - the audio thread picks the new map up in updateParameters()
+    // The LED parameters describe the default segment; the segment table, if any, overrides them per segment
+    SegmentConfig defaults;
+    defaults.lowestNote = static_cast<int>(*parameters.getRawParameterValue(PARAM_LOWEST_NOTE));
+    defaults.highestNote = juce::jmax(defaults.lowestNote, static_cast<int>(*parameters.getRawParameterValue(PARAM_HIGHEST_NOTE)));
+    defaults.ledOffset = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_OFFSET));
+    defaults.ledCount = static_cast<int>(*parameters.getRawParameterValue(PARAM_LED_COUNT));
+    defaults.mappingMode = static_cast<int>(*parameters.getRawParameterValue(PARAM_MAPPING_MODE));
+    defaults.ledsPerMetre = static_cast<int>(*parameters.getRawParameterValue(PARAM_LEDS_PER_METRE));
+    defaults.keyWidths = parameters.state.getProperty(PARAM_KEY_WIDTHS, "").toString();
+    
+    defaults.protocol = static_cast<int>(*parameters.getRawParameterValue(PARAM_PROTOCOL));
+    if (defaults.protocol == 2)
     {
-        // Adalight (USB Serial)
-        dmxSender = std::make_unique<AdalightSender>();
-        DBG("  Created AdalightSender");
+        // Adalight - serial port and baud rate
+        defaults.target = parameters.state.getProperty(PARAM_SERIAL_PORT, "").toString();
+        defaults.universe = static_cast<int>(*parameters.getRawParameterValue(PARAM_BAUD_RATE));
     }
     else
     {
-        // Default to E1.31 if unknown protocol
-        dmxSender = std::make_unique<E131Sender>();
-        DBG("  Created E131Sender (default/unknown)");
+        // Network protocol - IP and universe
+        defaults.target = parameters.state.getProperty(PARAM_WLED_IP, "239.255.0.1").toString();
+        defaults.universe = static_cast<int>(*parameters.getRawParameterValue(PARAM_UNIVERSE));
     }
     
-    // Re-read current values from ValueTree to avoid stale state
-    // This is critical for protocol switching: the member variables may have been
-    // set during a different protocol's lifecycle
-    currentWLEDIP = parameters.state.getProperty(PARAM_WLED_IP, "239.255.0.1").toString();
-    currentSerialPort = parameters.state.getProperty(PARAM_SERIAL_PORT, "").toString();
+    auto segmentConfigs = SegmentMap::parseSegmentTable(parameters.state.getProperty(PARAM_SEGMENTS, "").toString(), defaults);
+    if (segmentConfigs.isEmpty())
+        segmentConfigs.add(defaults);
+    
+    DBG("PluginProcessor::rebuildSegmentMap - " + juce::String(segmentConfigs.size()) + " segment(s)");
     
-    DBG("  Read from ValueTree - IP: '" + currentWLEDIP + "', Serial: '" + currentSerialPort + "'");
+    segmentNames.clear();
+    for (const auto& segment : segmentConfigs)
+        segmentNames.add(segment.name);
     
-    // Initialize with current settings
-    if (dmxSender)
+    const bool rgbw = static_cast<int>(*parameters.getRawParameterValue(PARAM_COLOUR_ORDER)) == static_cast<int>(ColourOrder::RGBW);
+    segmentBuffer.getWriteBuffer().compile(segmentConfigs, rgbw ? 4 : 3);
+    segmentBuffer.publish();
+}
+
+void KeyGlowAudioProcessor::rebuildRouting()
+{
+    // Message thread (or a tool's render thread) and the constructor - the audio thread picks the new table up in updateParameters()
+    PaletteSettings settings;
+    settings.mode = static_cast<PaletteMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_PALETTE_MODE)));
+    settings.hue = *parameters.getRawParameterValue(PARAM_COLOR_HUE);
+    settings.saturation = *parameters.getRawParameterValue(PARAM_COLOR_SAT);
+    settings.value = *parameters.getRawParameterValue(PARAM_COLOR_VAL);
+    settings.hueRange = *parameters.getRawParameterValue(PARAM_PALETTE_HUE_RANGE);
+    
+    routingBuffer.getWriteBuffer().build(parameters.state.getProperty(PARAM_ROUTING, "").toString(), settings, segmentNames);
+    routingBuffer.publish();
+}
+
+void KeyGlowAudioProcessor::applyShowMode()
+{
+    // Message thread (or a tool's render thread) - the output thread opens the file itself
+    auto mode = static_cast<ShowMode>(static_cast<int>(*parameters.getRawParameterValue(PARAM_SHOW_MODE)));
+    juce::String path = parameters.state.getProperty(PARAM_SHOW_FILE, "").toString();
+    
+    if (mode != ShowMode::Off && !juce::File::isAbsolutePath(path))
     {
-        if (protocol == 2)
-        {
-            // Adalight - use serial port and baud rate
-            DBG("  Calling setTargetIP with serial port: '" + currentSerialPort + "'");
-            dmxSender->setTargetIP(currentSerialPort);
-            DBG("  Calling setUniverse (baud rate) with: " + juce::String(currentBaudRate));
-            dmxSender->setUniverse(currentBaudRate);  // For Adalight, this sets the baud rate
-        }
-        else
-        {
-            // Network protocol - use IP and universe
-            DBG("  Calling setTargetIP with IP: '" + currentWLEDIP + "'");
-            dmxSender->setTargetIP(currentWLEDIP);
-            DBG("  Calling setUniverse with: " + juce::String(currentUniverse));
-            dmxSender->setUniverse(currentUniverse);  // For network protocols, this sets the universe number
-        }
-        DBG("  Sender initialized");
+        DBG("PluginProcessor::applyShowMode - no show file set");
+        mode = ShowMode::Off;
     }
-    DBG("============================================");
+    
+    outputScheduler.setShow(mode, mode != ShowMode::Off ? juce::File(path) : juce::File());
 }
 
 //==============================================================================
@@ -10,15 +10,28 @@
 
 #include <JuceHeader.h>
 #include "DMXSender.h"
-#include "ArtNetSender.h"
-#include "E131Sender.h"
-#include "AdalightSender.h"
+#include "KeyboardGeometry.h"
+#include "SegmentMap.h"
+#include "FrameCompositor.h"
+#include "LayerStack.h"
+#include "SpreadStage.h"
+#include "ParticleEngine.h"
+#include "ColourPalette.h"
+#include "ChannelRouting.h"
+#include "ControlModulation.h"
+#include "AudioAnalyser.h"
+#include "BeatEffects.h"
+#include "ShowFile.h"
+#include "TripleBuffer.h"
+#include "OutputScheduler.h"
 
 //==============================================================================
 /**
 */
 class KeyGlowAudioProcessor  : public juce::AudioProcessor,
-                                  public juce::ChangeBroadcaster
+                                  public juce::ChangeBroadcaster,
+                                  public juce::AudioProcessorValueTreeState::Listener,
+                                  private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -57,13 +70,33 @@ public:
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
+    
+    // Palette parameters trigger an asynchronous rebuild of the colour table
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
 
     //==============================================================================
     juce::AudioProcessorValueTreeState& getValueTreeState() { return parameters; }
     
+    // Rebuild changed tables right away on the calling thread - for hosts without a message loop
+    // (the command-line tools). Call between blocks, on the thread that calls processBlock
+    void rebuildPendingTables();
+    
     // Get active notes count for UI display
     int getActiveNotesCount() const { return activeNotes.size(); }
     
+    // Power limiter telemetry (last sent frame, safe to read from the UI thread)
+    float getEstimatedMilliamps() const { return estimatedMilliamps.load(); }
+    float getPowerLimiterScale() const { return powerLimiterScale.load(); }
+    
+    // Particle engine statistics (safe to read from the UI thread)
+    int getParticleCapacity() const { return MAX_PARTICLES; }
+    int getLiveParticleCount() const { return liveParticles.load(); }
+    int getParticleOverflowCount() const { return particleOverflows.load(); }
+    float getParticleFrameCostMs() const { return particleFrameCostMs.load(); }
+    
+    // Frames as sent to the strip, for the editor's LED preview (single reader)
+    TripleBuffer<LedPreviewFrame>& getLedPreviewFrames() { return outputScheduler.getPreviewFrames(); }
+    
     // Parameter IDs
     static constexpr const char* PARAM_LED_COUNT = "ledCount";
     static constexpr const char* PARAM_LED_OFFSET = "ledOffset";
@@ -76,11 +109,57 @@ public:
     static constexpr const char* PARAM_COLOR_HUE = "colorHue";
     static constexpr const char* PARAM_COLOR_SAT = "colorSat";
     static constexpr const char* PARAM_COLOR_VAL = "colorVal";
+    static constexpr const char* PARAM_PALETTE_MODE = "paletteMode";  // 0 = Single, 1 = Pitch class, 2 = Octave gradient, 3 = Velocity hue, 4 = MIDI channel
+    static constexpr const char* PARAM_PALETTE_HUE_RANGE = "paletteHueRange";  // Hue span of the gradient palettes
     static constexpr const char* PARAM_WLED_IP = "wledIP";
     static constexpr const char* PARAM_SERIAL_PORT = "serialPort";
     static constexpr const char* PARAM_PROTOCOL = "protocol";
     static constexpr const char* PARAM_UNIVERSE = "universe";  // Network protocols only (Art-Net, E1.31)
     static constexpr const char* PARAM_BAUD_RATE = "baudRate";  // Adalight serial only
+    static constexpr const char* PARAM_MAPPING_MODE = "mappingMode";  // 0 = Linear, 1 = Piano geometry
+    static constexpr const char* PARAM_LEDS_PER_METRE = "ledsPerMetre";  // LED strip density (piano geometry only)
+    static constexpr const char* PARAM_KEY_WIDTHS = "keyWidths";  // Optional per-key widths in mm (ValueTree property)
+    static constexpr const char* PARAM_SEGMENTS = "segments";  // Optional segment table, JSON (ValueTree property) - empty = one segment from the LED parameters
+    static constexpr const char* PARAM_SHOW_FILE = "showFile";  // Show file to record to / play, or an fseq sequence to play (ValueTree property)
+    static constexpr const char* PARAM_BOUNCE_FILE = "bounceFile";  // Show file offline renders are recorded to (ValueTree property) - empty = don't record
+    static constexpr const char* PARAM_ROUTING = "routing";  // Optional MIDI channel routing table, JSON (ValueTree property) - empty = all channels everywhere
+    static constexpr const char* PARAM_BRIGHTNESS = "brightness";  // Master brightness
+    static constexpr const char* PARAM_GAMMA = "gamma";  // Output gamma (1.0 = linear)
+    static constexpr const char* PARAM_COLOUR_ORDER = "colourOrder";  // 0 = RGB, 1 = GRB, 2 = BGR, 3 = RGBW
+    static constexpr const char* PARAM_CALIBRATION_RED = "calibrationRed";  // Per-channel white balance
+    static constexpr const char* PARAM_CALIBRATION_GREEN = "calibrationGreen";
+    static constexpr const char* PARAM_CALIBRATION_BLUE = "calibrationBlue";
+    static constexpr const char* PARAM_DITHERING = "dithering";  // Temporal dithering of the 16-bit output stage
+    static constexpr const char* PARAM_FRAME_RATE = "frameRate";  // LED output frames per second while notes are active
+    static constexpr const char* PARAM_KEEP_ALIVE = "keepAlive";  // Refresh interval (ms) for unchanged universes, 0 = always send
+    static constexpr const char* PARAM_POWER_LIMIT = "powerLimit";  // Power supply budget in mA, 0 = limiter off
+    static constexpr const char* PARAM_MILLIAMPS_PER_CHANNEL = "milliampsPerChannel";  // Draw of one LED channel at full level
+    static constexpr const char* PARAM_GLOW_MODE = "glowMode";  // 0 = Off, 1 = Gaussian, 2 = Exponential
+    static constexpr const char* PARAM_GLOW_RADIUS = "glowRadius";  // Glow reach in LEDs
+    static constexpr const char* PARAM_GLOW_AMOUNT = "glowAmount";  // Glow intensity relative to the lit key
+    static constexpr const char* PARAM_GLOW_VELOCITY = "glowVelocity";  // How strongly velocity scales the glow (0 = not at all)
+    static constexpr const char* PARAM_EFFECT_MODE = "effectMode";  // Note-triggered effect: 0 = Off, 1 = Ripple, 2 = Sparks
+    static constexpr const char* PARAM_EFFECT_SPEED = "effectSpeed";  // Particle speed in LEDs per second
+    static constexpr const char* PARAM_EFFECT_LIFETIME = "effectLifetime";  // Particle lifetime in seconds
+    static constexpr const char* PARAM_EFFECT_BLEND = "effectBlend";  // Blend mode of the particle layer: 0 = Add, 1 = Max, 2 = Screen, 3 = Alpha
+    static constexpr const char* PARAM_EFFECT_OPACITY = "effectOpacity";  // Opacity of the particle layer
+    static constexpr const char* PARAM_AMBIENT_MODE = "ambientMode";  // Idle animation: 0 = Off, 1 = Breathing, 2 = Gradient, 3 = Noise
+    static constexpr const char* PARAM_AMBIENT_BRIGHTNESS = "ambientBrightness";  // Peak level of the idle animation, 0 = off
+    static constexpr const char* PARAM_AMBIENT_SPEED = "ambientSpeed";  // Idle animation cycles per second
+    static constexpr const char* PARAM_AMBIENT_FRAME_RATE = "ambientFrameRate";  // Idle animation frames per second (output thread)
+    static constexpr const char* PARAM_BRIGHTNESS_CC = "brightnessCC";  // CC scaling all voices (1 = mod wheel), 0 = off
+    static constexpr const char* PARAM_HUE_CC = "hueCC";  // CC shifting the hue per channel (74 = MPE timbre), 0 = off
+    static constexpr const char* PARAM_HUE_MOD_DEPTH = "hueModDepth";  // Hue shift at full hue CC or pitch bend
+    static constexpr const char* PARAM_PRESSURE_DEPTH = "pressureDepth";  // How far aftertouch lifts a voice towards full brightness
+    static constexpr const char* PARAM_AUDIO_MODE = "audioMode";  // Audio-reactive layer (sidechain): 0 = Off, 1 = Spectrum, 2 = Flash, 3 = Both
+    static constexpr const char* PARAM_AUDIO_SENSITIVITY = "audioSensitivity";  // Input gain of the analysis in dB
+    static constexpr const char* PARAM_AUDIO_LEVEL = "audioLevel";  // Opacity of the audio-reactive layer
+    static constexpr const char* PARAM_BEAT_EFFECT = "beatEffect";  // Tempo-synced effect: 0 = Off, 1 = Strobe, 2 = Chase, 3 = Colour cycle
+    static constexpr const char* PARAM_BEAT_DIVISION = "beatDivision";  // Effect cycle: 0 = 1 bar, 1 = 1/2, 2 = 1/4, 3 = 1/8, 4 = 1/16
+    static constexpr const char* PARAM_BEAT_LEVEL = "beatLevel";  // Brightness of the beat effect
+    static constexpr const char* PARAM_LIGHT_DELAY = "lightDelay";  // Extra output latency (converters, speakers) in ms the LEDs wait for
+    static constexpr const char* PARAM_AUTO_DELAY = "autoDelay";  // Also wait for the host's output buffer (one block)
+    static constexpr const char* PARAM_SHOW_MODE = "showMode";  // Show file: 0 = Off, 1 = Record, 2 = Play
     
     // MIDI learn state
     enum class MidiLearnState
@@ -105,14 +184,18 @@ private:
     //==============================================================================
     juce::AudioProcessorValueTreeState parameters;
     
-    // DMX protocol sender (abstract interface)
-    std::unique_ptr<DMXSender> dmxSender;
+    // Output thread - owns the protocol sender, sends note frames and renders the idle animation
+    OutputScheduler outputScheduler;
+    OutputConfig outputConfig;  // Last configuration handed to the output thread
     
     // Active notes tracking
     struct ActiveNote
     {
         int midiNote;
-        int ledIndex;
+        int midiChannel = 1;  // 1-16, voices are per channel (the same key on two channels is two notes)
+        juce::uint32 segmentMask = SegmentMap::ALL_SEGMENTS;  // Segments the channel is routed to
+        float intensity = 1.0f;    // Velocity with aftertouch and the brightness CC applied (once per frame)
+        juce::Colour renderColour; // Colour with the hue modulation applied (once per frame)
         float velocity;
         ADSREnvelope envelope;
         juce::Colour color;
@@ -122,8 +205,15 @@ private:
     
     juce::Array<ActiveNote> activeNotes;
     
-    // Sustain pedal state (CC 64)
-    bool sustainPedalActive = false;
+    // Sustain pedal state (CC 64), per MIDI channel
+    bool sustainPedalActive[16] = {};
+    
+    // Controller modulation, coalesced per output frame
+    ControlModulation modulation;
+    int currentBrightnessCC = 0;
+    int currentHueCC = 0;
+    float currentHueModDepth = 0.0f;
+    float currentPressureDepth = 0.0f;
     
     // Current parameters
     int currentLEDCount = 88;
@@ -135,7 +225,74 @@ private:
     int currentProtocol = 1;       // 0 = Art-Net, 1 = E1.31 (default), 2 = Adalight
     int currentUniverse = 1;       // Universe number for network protocols (Art-Net, E1.31)
     int currentBaudRate = 115200;  // Baud rate for Adalight serial
-    juce::Colour currentColor = juce::Colours::white;
+    int currentMappingMode = 0;    // 0 = Linear, 1 = Piano geometry
+    int currentLEDsPerMetre = 60;  // LED strip density for piano geometry mapping
+    juce::String currentKeyWidths = "";  // Custom key widths (mm), empty = standard piano dimensions
+    juce::String currentSegmentTable = "";  // Segment table (JSON), empty = single segment
+    juce::String currentRoutingTable = "";  // MIDI channel routing table (JSON), empty = no routing
+    juce::StringArray segmentNames;         // Names of the compiled segments, for the routing table (message thread)
+    
+    int currentColourOrder = 0;    // 0 = RGB, 1 = GRB, 2 = BGR, 3 = RGBW
+    
+    // Segment table compiled into per-note render instructions, rebuilt on the message thread
+    // whenever the mapping or output configuration changes
+    TripleBuffer<SegmentMap> segmentBuffer;
+    std::atomic<bool> segmentMapDirty { false };
+    std::atomic<bool> routingDirty { false };
+    std::atomic<bool> showDirty { false };
+    std::atomic<bool> transferDirty { false };
+    int currentShowMode = 0;
+    juce::String currentShowFile = "";
+    
+    // Piano-roll history of the matrix segment (ring buffer, allocated in prepareToPlay)
+    MatrixCanvas matrixCanvas;
+    
+    // Sidechain analysis on its own thread, feeding the audio-reactive layer
+    AudioAnalyser audioAnalyser;
+    AudioReactiveMode currentAudioMode = AudioReactiveMode::Off;
+    float audioBandColours[AudioAnalysisFrame::NUM_BANDS][3] = {};  // Palette colour of each band's centre note
+    
+    // Host transport (captured once per block) and the tempo-synced effect it drives
+    TransportSnapshot transport;
+    juce::int64 frameDeadline = 0;  // Sample time the frame being rendered is due at
+    
+    // Light-to-sound latency compensation: frames are released by the output thread when their audio is heard
+    juce::int64 blockStartSample = 0;
+    double blockStartMs = 0.0;      // Wall-clock time of the current processBlock() call
+    double outputLatencyMs = 0.0;   // Configured delay plus, if enabled, the host buffer
+    
+    // Offline renders (bounces) send nothing live; frames optionally go to a show file instead
+    bool renderingOffline = false;
+    ShowRecorder bounceWriter;
+    juce::int64 bounceStartSample = 0;
+    BeatEffect currentBeatEffect = BeatEffect::Off;
+    double currentBeatCycle = 1.0;  // Quarter notes
+    float currentBeatLevel = 0.5f;
+    bool effectWasLit = false;      // Beat or audio layer drew last block - a trailing frame clears it when it stops
+    
+    // Float layers blended in fixed point, then gamma/brightness/colour-order conversion to wire format
+    LayerStack layerStack;
+    FrameCompositor compositor;
+    TripleBuffer<OutputTransferTable> transferBuffer;  // Gamma/calibration LUTs, built on the message thread
+    SpreadStage spreadStage;
+    float currentGlowVelocity = 0.5f;
+    
+    // Note-triggered particles (pool allocated in prepareToPlay)
+    static constexpr int MAX_PARTICLES = 2048;
+    ParticleEngine particleEngine;
+    juce::int64 sampleClock = 0;               // Samples processed since construction
+    juce::int64 lastParticleUpdateClock = 0;
+    std::atomic<int> liveParticles { 0 };
+    std::atomic<int> particleOverflows { 0 };
+    std::atomic<float> particleFrameCostMs { 0.0f };
+    
+    // Power limiter telemetry
+    std::atomic<float> estimatedMilliamps { 0.0f };
+    std::atomic<float> powerLimiterScale { 1.0f };
+    
+    // MIDI channel routing and note colours, precomputed on the message thread whenever a palette
+    // parameter, the routing table or the segment table changes
+    TripleBuffer<ChannelRouting> routingBuffer;
     
     // ADSR parameters (piano-like defaults)
     float attackTime = 0.1f;
@@ -146,28 +303,33 @@ private:
     // Sample rate for envelope calculation
     double sampleRate = 44100.0;
     
-    // Update rate for LED output when notes are active (send at ~30Hz to avoid serial bandwidth saturation)
+    // Update rate for LED output when notes are active (default 30Hz to avoid serial bandwidth saturation)
     // At 115200 baud: max 50.5 fps theoretical, 30 fps = 59% capacity (safe headroom)
-    // Computed dynamically from sampleRate in prepareToPlay() to handle 44.1/48/96kHz etc.
+    // Network protocols can run much faster, which also makes temporal dithering invisible
+    // Computed dynamically from sampleRate and the frame rate parameter to handle 44.1/48/96kHz etc.
     int updateCounter = 0;
-    static constexpr int TARGET_UPDATE_HZ = 30;
+    int currentFrameRate = 30;
     int updateInterval = 1470; // default for 44100Hz, recalculated in prepareToPlay()
     
-    // Previous LED count for visual feedback
-    int previousLEDCount = 0;
+    // The LED range changed: show the configuration pattern once the recompiled segment map arrives
+    bool feedbackPending = false;
     
     // Pre-allocated buffer for LED output (avoids heap allocation on audio thread)
-    // Max size: 512 LEDs * 3 channels = 1536 bytes
-    static constexpr int MAX_DMX_BUFFER_SIZE = 512 * 3;
+    // Max size: 1024 LEDs (all segments) * 4 channels (RGBW) = 4096 bytes
+    static constexpr int MAX_LEDS = SegmentMap::MAX_PIXELS;
+    static constexpr int MAX_DMX_BUFFER_SIZE = MAX_LEDS * 4;
     uint8_t dmxBuffer[MAX_DMX_BUFFER_SIZE] = {0};
     
     void updateParameters();
     void processMidiMessages(juce::MidiBuffer& midiMessages);
-    void updateArtNetOutput();
-    int midiNoteToLEDIndex(int midiNote) const;
-    void sendVisualFeedback();
-    void sendVisualFeedbackWithRange(int rangeLEDCount);
-    void createProtocolSender(int protocol);
+    void updateArtNetOutput(bool periodicFrame);  // periodicFrame: on the frame clock (advances the piano roll)
+    void rebuildSegmentMap();
+    void sendVisualFeedback(int clearPixels);
+    void publishOutputConfig(bool force = false);
+    void rebuildRouting();
+    void rebuildOutputTransfer();
+    void applyShowMode();
+    void handleAsyncUpdate() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KeyGlowAudioProcessor)
 };
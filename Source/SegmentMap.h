@@ -0,0 +1,435 @@
+/*
+  ==============================================================================
+
+    SegmentMap.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DMXSender.h"
+#include "KeyboardGeometry.h"
+#include "MatrixCanvas.h"
+
+// Where a segment takes its note colours from
+enum class SegmentColourMode
+{
+    Palette = 0,  // Note colour from the palette
+    Fixed         // The segment's own colour for every note
+};
+
+// One LED run of the rig (keyboard bar, side column, ceiling strip, ...):
+// a note range mapped onto an LED range of one output destination
+struct SegmentConfig
+{
+    juce::String name;
+    int lowestNote = 21;
+    int highestNote = 108;
+    int ledOffset = 0;        // First LED on the destination strip
+    int ledCount = 88;
+    bool reversed = false;    // Highest note at the first LED
+    int mappingMode = 0;      // 0 = Linear, 1 = Piano geometry
+    int ledsPerMetre = 60;
+    juce::String keyWidths;   // Custom key widths in mm (piano geometry only)
+    SegmentColourMode colourMode = SegmentColourMode::Palette;
+    juce::Colour colour;      // Fixed colour mode only
+
+    // Matrix segments (width > 0) show a scrolling piano roll instead of lighting note spans:
+    // notes across the width, newest row at the top. ledCount = width * height
+    int matrixWidth = 0;
+    int matrixHeight = 0;
+    juce::String matrixLayout;  // "rows", "serpentine", "columns", "columnSerpentine" or a pixel map file
+
+    // Output destination - segments with the same destination share one sender and packet
+    int protocol = 1;                  // 0 = Art-Net, 1 = E1.31, 2 = Adalight
+    juce::String target = "239.255.0.1"; // IP address, or serial port for Adalight
+    int universe = 1;                  // Start universe, or baud rate for Adalight
+};
+
+// One protocol sender. Its LEDs occupy [firstPixel, firstPixel + numPixels) of the segment frame
+struct OutputDestination
+{
+    int protocol = 1;
+    juce::String target;
+    int universe = 1;
+    int firstPixel = 0;
+    int numPixels = 0;
+
+    bool isSameSender(const SegmentConfig& segment) const
+    {
+        return protocol == segment.protocol && target == segment.target && universe == segment.universe;
+    }
+
+    bool operator== (const OutputDestination& other) const
+    {
+        return protocol == other.protocol && target == other.target && universe == other.universe
+            && firstPixel == other.firstPixel && numPixels == other.numPixels;
+    }
+};
+
+struct PixelRange
+{
+    int firstPixel = 0;
+    int numPixels = 0;
+
+    bool operator== (const PixelRange& other) const { return firstPixel == other.firstPixel && numPixels == other.numPixels; }
+};
+
+// Piano-roll matrix of the segment map (at most one)
+struct MatrixTarget
+{
+    static constexpr int MAX_PIXELS = 512;
+
+    int width = 0;          // 0 = no matrix
+    int height = 0;
+    int firstPixel = 0;     // First LED in the segment frame
+    juce::uint32 segmentBit = 0;  // Bit of the segment in a channel's segment mask
+    int16_t pixelMap[MAX_PIXELS] = {};  // Wire pixel -> canvas pixel, see MatrixPixelMap
+    PixelRange noteColumns[128];        // Canvas columns of each note (numPixels = 0: not shown)
+    float paletteMix = 1.0f;            // Same colour blend as RenderInstruction
+    float fixedRed = 0.0f;
+    float fixedGreen = 0.0f;
+    float fixedBlue = 0.0f;
+
+    bool isEnabled() const { return width > 0 && height > 0; }
+    int getNumPixels() const { return width * height; }
+};
+
+// One LED span lit by a note, already placed in the segment frame
+// The colour is blended branch-free: paletteMix * note colour + (1 - paletteMix) * fixed colour
+struct RenderInstruction
+{
+    int firstPixel = 0;
+    int numPixels = 0;
+    juce::uint32 segmentBit = 0;  // Bit of the segment in a channel's segment mask
+    float paletteMix = 1.0f;
+    float fixedRed = 0.0f;
+    float fixedGreen = 0.0f;
+    float fixedBlue = 0.0f;
+};
+
+// Segment table compiled into flat render instructions
+//
+// Destinations are laid out back to back in one "segment frame", each covering LEDs 0 to the
+// end of its last segment, so every destination's packet is a contiguous slice of the wire
+// frame. All mapping decisions (note range, direction, geometry, colour mode) are resolved here,
+// so rendering a note is a loop over its instructions with no configuration checks.
+// A network destination longer than one sender carries continues in further senders on the
+// following universes, so one segment may span several destinations.
+// Compiled on the message thread and handed to the audio thread through a TripleBuffer.
+struct SegmentMap
+{
+    static constexpr int MAX_SEGMENTS = 8;
+    static constexpr int MAX_PIXELS = 1024;             // Whole segment frame, all destinations
+    static constexpr int MAX_DESTINATION_PIXELS = 512;  // One sender
+    static constexpr juce::uint32 ALL_SEGMENTS = 0xffffffffu;
+
+    RenderInstruction instructions[128 * MAX_SEGMENTS];
+    int noteStart[129] = {};  // Instructions of note n are [noteStart[n], noteStart[n + 1])
+
+    PixelRange segmentRanges[MAX_SEGMENTS];  // LED range of each segment in the segment frame
+    int numSegments = 0;
+    PixelRange stripRanges[MAX_SEGMENTS];    // The same for strip segments only (glow, particles)
+    int numStripSegments = 0;
+    MatrixTarget matrix;
+    OutputDestination destinations[MAX_SEGMENTS];
+    int numDestinations = 0;
+    int totalPixels = 0;
+
+    const RenderInstruction* begin(int midiNote) const { return instructions + noteStart[juce::jlimit(0, 127, midiNote)]; }
+    const RenderInstruction* end(int midiNote) const { return instructions + noteStart[juce::jlimit(0, 127, midiNote) + 1]; }
+    // True if the note lights anything in the segments of segmentMask (see ChannelRouting)
+    bool isMapped(int midiNote, juce::uint32 segmentMask = ALL_SEGMENTS) const
+    {
+        for (auto* instruction = begin(midiNote); instruction != end(midiNote); ++instruction)
+            if ((instruction->segmentBit & segmentMask) != 0)
+                return true;
+
+        return matrix.isEnabled() && (matrix.segmentBit & segmentMask) != 0
+            && matrix.noteColumns[juce::jlimit(0, 127, midiNote)].numPixels > 0;
+    }
+
+    // channelsPerPixel (3, or 4 for RGBW) decides where long network destinations are split
+    void compile(const juce::Array<SegmentConfig>& segments, int channelsPerPixel = 3)
+    {
+        numSegments = juce::jmin(MAX_SEGMENTS, segments.size());
+        numStripSegments = 0;
+        numDestinations = 0;
+        totalPixels = 0;
+        matrix.width = matrix.height = 0;
+
+        // Group segments by destination
+        int destinationOf[MAX_SEGMENTS] = {};
+        for (int s = 0; s < numSegments; s++)
+        {
+            const auto& segment = segments.getReference(s);
+            int d = 0;
+            while (d < numDestinations && !destinations[d].isSameSender(segment))
+                d++;
+
+            if (d == numDestinations)
+            {
+                auto& destination = destinations[numDestinations++];
+                destination.protocol = segment.protocol;
+                destination.target = segment.target;
+                destination.universe = segment.universe;
+                destination.numPixels = 0;
+            }
+
+            // A serial port is one sender; network destinations are split further down
+            destinationOf[s] = d;
+            destinations[d].numPixels = juce::jlimit(destinations[d].numPixels, isSerial(segment.protocol) ? MAX_DESTINATION_PIXELS : MAX_PIXELS,
+                                                     segment.ledOffset + segment.ledCount);
+        }
+
+        // Lay the destinations out back to back
+        for (int d = 0; d < numDestinations; d++)
+        {
+            auto& destination = destinations[d];
+            destination.firstPixel = totalPixels;
+            destination.numPixels = juce::jmin(destination.numPixels, MAX_PIXELS - totalPixels);
+            totalPixels += destination.numPixels;
+        }
+
+        // Note -> LED spans of every segment, relative to the segment's first LED
+        NoteSpanMap spanMaps[MAX_SEGMENTS];
+        for (int s = 0; s < numSegments; s++)
+        {
+            const auto& segment = segments.getReference(s);
+            const auto& destination = destinations[destinationOf[s]];
+
+            auto& range = segmentRanges[s];
+            range.firstPixel = destination.firstPixel + juce::jlimit(0, destination.numPixels, segment.ledOffset);
+            range.numPixels = juce::jlimit(0, destination.firstPixel + destination.numPixels - range.firstPixel, segment.ledCount);
+
+            if (segment.matrixWidth > 0)
+            {
+                compileMatrix(segment, range, 1u << s);
+                continue;
+            }
+
+            stripRanges[numStripSegments++] = range;
+
+            if (segment.mappingMode == 1)
+                KeyboardGeometry::buildPianoGeometry(spanMaps[s], segment.lowestNote, segment.highestNote, range.numPixels, 0,
+                                                     static_cast<float>(segment.ledsPerMetre),
+                                                     KeyboardGeometry::parseKeyWidthTable(segment.keyWidths));
+            else
+                KeyboardGeometry::buildLinear(spanMaps[s], segment.lowestNote, segment.highestNote, range.numPixels, 0);
+        }
+
+        splitDestinations(channelsPerPixel);
+
+        // Emit the instructions note by note
+        int count = 0;
+        for (int note = 0; note < 128; note++)
+        {
+            noteStart[note] = count;
+
+            for (int s = 0; s < numSegments; s++)
+            {
+                const auto& segment = segments.getReference(s);
+                const auto& span = spanMaps[s][note];
+                const int segmentLEDs = segmentRanges[s].numPixels;
+
+                if (segment.matrixWidth > 0 || note < segment.lowestNote || note > segment.highestNote || span.numLEDs <= 0)
+                    continue;
+
+                int first = segment.reversed ? segmentLEDs - span.firstLED - span.numLEDs : span.firstLED;
+                int last = first + span.numLEDs - 1;
+                first = juce::jmax(0, first);
+                last = juce::jmin(segmentLEDs - 1, last);
+                if (last < first)
+                    continue;
+
+                auto& instruction = instructions[count++];
+                instruction.firstPixel = segmentRanges[s].firstPixel + first;
+                instruction.numPixels = last - first + 1;
+                instruction.segmentBit = 1u << s;
+
+                const bool fixedColour = segment.colourMode == SegmentColourMode::Fixed;
+                instruction.paletteMix = fixedColour ? 0.0f : 1.0f;
+                instruction.fixedRed = fixedColour ? segment.colour.getFloatRed() : 0.0f;
+                instruction.fixedGreen = fixedColour ? segment.colour.getFloatGreen() : 0.0f;
+                instruction.fixedBlue = fixedColour ? segment.colour.getFloatBlue() : 0.0f;
+            }
+        }
+
+        noteStart[128] = count;
+    }
+
+    static bool isSerial(int protocol) { return protocol == 2; }
+
+    // Network destinations over MAX_DESTINATION_PIXELS continue in further senders, split on whole
+    // universes so the continuation starts on the universe the single sender would have used next
+    void splitDestinations(int channelsPerPixel)
+    {
+        const int ledsPerUniverse = DMXSender::DMX_CHANNELS_PER_UNIVERSE / juce::jlimit(3, 4, channelsPerPixel);
+        const int universesPerSender = MAX_DESTINATION_PIXELS / ledsPerUniverse;
+
+        OutputDestination split[MAX_SEGMENTS];
+        int numSplit = 0;
+
+        for (int d = 0; d < numDestinations; d++)
+        {
+            OutputDestination part = destinations[d];
+            int remaining = part.numPixels;
+
+            while (remaining > 0 && numSplit < MAX_SEGMENTS)
+            {
+                part.numPixels = juce::jmin(remaining, universesPerSender * ledsPerUniverse);
+                split[numSplit++] = part;
+
+                remaining -= part.numPixels;
+                part.firstPixel += part.numPixels;
+                part.universe += universesPerSender;
+            }
+
+            if (remaining > 0)
+            {
+                DBG("SegmentMap::compile - out of senders, the last " + juce::String(remaining) + " LEDs of '" + part.target + "' are not sent");
+            }
+        }
+
+        std::copy(split, split + numSplit, destinations);
+        numDestinations = numSplit;
+    }
+
+    // Matrix: wire order pixel map and the canvas columns of every note
+    void compileMatrix(const SegmentConfig& segment, const PixelRange& range, juce::uint32 segmentBit)
+    {
+        if (matrix.isEnabled())
+        {
+            DBG("SegmentMap::compile - only one matrix segment is supported, ignoring '" + segment.name + "'");
+            return;
+        }
+
+        matrix.width = juce::jlimit(0, MatrixTarget::MAX_PIXELS, segment.matrixWidth);
+        matrix.height = matrix.width > 0 ? juce::jmin(segment.matrixHeight, range.numPixels / matrix.width) : 0;
+        matrix.firstPixel = range.firstPixel;
+        matrix.segmentBit = segmentBit;
+
+        if (!matrix.isEnabled())
+            return;
+
+        const juce::String& layout = segment.matrixLayout;
+        if (layout.isEmpty() || layout == "rows")
+            MatrixPixelMap::build(matrix.pixelMap, matrix.width, matrix.height, MatrixLayout::Rows);
+        else if (layout == "serpentine")
+            MatrixPixelMap::build(matrix.pixelMap, matrix.width, matrix.height, MatrixLayout::Serpentine);
+        else if (layout == "columns")
+            MatrixPixelMap::build(matrix.pixelMap, matrix.width, matrix.height, MatrixLayout::Columns);
+        else if (layout == "columnSerpentine")
+            MatrixPixelMap::build(matrix.pixelMap, matrix.width, matrix.height, MatrixLayout::ColumnSerpentine);
+        else if (!MatrixPixelMap::loadFromFile(juce::File(layout), matrix.pixelMap, matrix.width, matrix.height))
+        {
+            DBG("SegmentMap::compile - cannot use pixel map '" + layout + "', falling back to rows");
+            MatrixPixelMap::build(matrix.pixelMap, matrix.width, matrix.height, MatrixLayout::Rows);
+        }
+
+        // Notes spread evenly across the width, at least one column each
+        const int numNotes = segment.highestNote - segment.lowestNote + 1;
+        for (int note = 0; note < 128; note++)
+        {
+            auto& columns = matrix.noteColumns[note];
+            columns.firstPixel = 0;
+            columns.numPixels = 0;
+
+            if (note < segment.lowestNote || note > segment.highestNote)
+                continue;
+
+            const int index = note - segment.lowestNote;
+            const int first = index * matrix.width / numNotes;
+            const int end = juce::jmax(first + 1, (index + 1) * matrix.width / numNotes);
+            columns.firstPixel = segment.reversed ? matrix.width - end : first;
+            columns.numPixels = end - first;
+        }
+
+        const bool fixedColour = segment.colourMode == SegmentColourMode::Fixed;
+        matrix.paletteMix = fixedColour ? 0.0f : 1.0f;
+        matrix.fixedRed = fixedColour ? segment.colour.getFloatRed() : 0.0f;
+        matrix.fixedGreen = fixedColour ? segment.colour.getFloatGreen() : 0.0f;
+        matrix.fixedBlue = fixedColour ? segment.colour.getFloatBlue() : 0.0f;
+    }
+
+    // Parse the segment table (JSON array of objects). Missing fields fall back to the defaults,
+    // which are the plugin's own LED parameters, e.g.
+    //   [ { "name": "Keys", "lowestNote": 21, "highestNote": 108, "ledCount": 176, "mapping": "piano" },
+    //     { "name": "Left column", "lowestNote": 21, "highestNote": 59, "ledCount": 60, "reversed": true,
+    //       "colour": "#ff8000", "protocol": 0, "target": "192.168.1.51", "universe": 0 } ]
+    static juce::Array<SegmentConfig> parseSegmentTable(const juce::String& json, const SegmentConfig& defaults)
+    {
+        juce::Array<SegmentConfig> segments;
+        const juce::var parsed = juce::JSON::parse(json);
+
+        if (!parsed.isArray())
+            return segments;
+
+        for (const auto& entry : *parsed.getArray())
+        {
+            if (!entry.isObject())
+                continue;
+
+            SegmentConfig segment = defaults;
+            segment.name = entry.getProperty("name", segment.name).toString();
+            segment.lowestNote = juce::jlimit(0, 127, static_cast<int>(entry.getProperty("lowestNote", segment.lowestNote)));
+            segment.highestNote = juce::jlimit(segment.lowestNote, 127, static_cast<int>(entry.getProperty("highestNote", segment.highestNote)));
+            segment.ledOffset = juce::jlimit(0, MAX_DESTINATION_PIXELS, static_cast<int>(entry.getProperty("ledOffset", segment.ledOffset)));
+            segment.ledCount = juce::jlimit(0, MAX_DESTINATION_PIXELS, static_cast<int>(entry.getProperty("ledCount", segment.ledCount)));
+            segment.reversed = static_cast<bool>(entry.getProperty("reversed", segment.reversed));
+            segment.ledsPerMetre = juce::jlimit(10, 240, static_cast<int>(entry.getProperty("ledsPerMetre", segment.ledsPerMetre)));
+            segment.keyWidths = entry.getProperty("keyWidths", segment.keyWidths).toString();
+
+            // "matrix": { "width": 32, "height": 16, "layout": "serpentine" }
+            const juce::var matrix = entry.getProperty("matrix", juce::var());
+            if (matrix.isObject())
+            {
+                segment.matrixWidth = juce::jlimit(1, MatrixTarget::MAX_PIXELS, static_cast<int>(matrix.getProperty("width", 32)));
+                segment.matrixHeight = juce::jlimit(1, MatrixTarget::MAX_PIXELS / segment.matrixWidth, static_cast<int>(matrix.getProperty("height", 16)));
+                segment.matrixLayout = matrix.getProperty("layout", "serpentine").toString();
+                segment.ledCount = segment.matrixWidth * segment.matrixHeight;
+            }
+
+            if (entry.hasProperty("mapping"))
+                segment.mappingMode = entry.getProperty("mapping", "").toString() == "piano" ? 1 : 0;
+
+            if (entry.hasProperty("colour"))
+            {
+                const juce::String colour = entry.getProperty("colour", "").toString().trim();
+                if (colour == "palette")
+                {
+                    segment.colourMode = SegmentColourMode::Palette;
+                }
+                else
+                {
+                    // "#rrggbb"
+                    segment.colourMode = SegmentColourMode::Fixed;
+                    segment.colour = juce::Colour::fromString("ff" + colour.removeCharacters("#"));
+                }
+            }
+
+            if (entry.hasProperty("protocol"))
+            {
+                segment.protocol = juce::jlimit(0, 2, static_cast<int>(entry.getProperty("protocol", segment.protocol)));
+                segment.target = entry.getProperty("target", segment.protocol == 2 ? juce::String() : juce::String("239.255.0.1")).toString();
+                segment.universe = static_cast<int>(entry.getProperty("universe", segment.protocol == 2 ? 115200 : 1));
+            }
+            else
+            {
+                segment.target = entry.getProperty("target", segment.target).toString();
+                segment.universe = static_cast<int>(entry.getProperty("universe", segment.universe));
+            }
+
+            segments.add(segment);
+
+            if (segments.size() == MAX_SEGMENTS)
+                break;
+        }
+
+        return segments;
+    }
+};
@@ -0,0 +1,409 @@
+/*
+  ==============================================================================
+
+    ShowFile.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// KeyGlow show file: the wire frames KeyGlow produced, each with its time
+//
+// Layout (native little endian, so the player can use the file in place):
+//   Header       fixed size, see below
+//   Payloads     one per frame, back to back - raw wire bytes, or a delta against the previous frame
+//   Index        numFrames IndexEntry records at indexOffset, written when recording ends
+//
+// A delta payload is a list of runs: uint16 skip (bytes unchanged since the previous frame),
+// uint16 length, then length new bytes. Every KEYFRAME_INTERVAL-th frame (and any frame that
+// changes size or would not get smaller) is stored raw, so reaching any frame costs at most
+// KEYFRAME_INTERVAL - 1 deltas.
+//
+// The wire data is exactly what the senders get (colour order, gamma and brightness applied),
+// so a show file can be replayed without any of the render settings.
+struct ShowFile
+{
+    static constexpr const char* FILE_EXTENSION = ".kgshow";
+    static constexpr juce::uint32 VERSION = 2;
+    static constexpr int KEYFRAME_INTERVAL = 64;
+    static constexpr int MAX_CHANNELS = 65535;  // Delta runs use 16-bit lengths
+
+    struct Header
+    {
+        char magic[4] = { 'K', 'G', 'S', 'H' };
+        juce::uint32 version = VERSION;
+        double ticksPerSecond = 1000000.0;  // Unit of the frame times (sample rate for offline renders)
+        juce::uint32 numFrames = 0;
+        juce::uint32 maxChannels = 0;       // Largest frame, so a player can size its buffer up front
+        juce::uint64 indexOffset = 0;       // 0 = recording did not finish, no index
+        juce::uint32 keyframeInterval = KEYFRAME_INTERVAL;
+        juce::uint32 reserved = 0;
+    };
+
+    struct IndexEntry
+    {
+        juce::int64 time = 0;
+        juce::uint64 offset = 0;        // Payload position in the file
+        juce::uint32 size = 0;          // Payload bytes
+        juce::uint32 numChannels = 0;   // Wire bytes once decoded
+        juce::uint32 keyframe = 0;      // Raw frame the delta chain of this frame starts from
+        juce::uint32 isDelta = 0;
+    };
+
+    static_assert(sizeof(Header) == 40, "Show file header must be packed");
+    static_assert(sizeof(IndexEntry) == 32, "Show file index entries must be packed");
+};
+
+// Records frames into a show file
+//
+// Frames are encoded into a preallocated write buffer that goes to disk in large blocks, so the
+// per-frame cost is the delta encoding and a memcpy - cheap enough for the output thread (and for
+// offline renders). Never use it on a live audio thread: a full buffer means file I/O.
+class ShowRecorder
+{
+public:
+    static constexpr int WRITE_BUFFER_SIZE = 1 << 18;
+    static constexpr int RESERVED_FRAMES = 60 * 60 * 60;  // Index room for an hour at 60 fps before it grows
+
+    ~ShowRecorder()
+    {
+        close();
+    }
+
+    bool open(const juce::File& file, double ticksPerSecond)
+    {
+        close();
+
+        file.deleteFile();
+        stream = std::make_unique<juce::FileOutputStream>(file, WRITE_BUFFER_SIZE);
+        if (!stream->openedOk())
+        {
+            DBG("ShowRecorder::open - cannot write " + file.getFullPathName());
+            stream.reset();
+            return false;
+        }
+
+        header = ShowFile::Header();
+        header.ticksPerSecond = ticksPerSecond;
+        stream->write(&header, sizeof(header));
+
+        writeBuffer.malloc(WRITE_BUFFER_SIZE);
+        previousFrame.calloc(ShowFile::MAX_CHANNELS);
+        writePosition = 0;
+        fileOffset = sizeof(header);
+        previousChannels = -1;
+        keyframe = 0;
+
+        index.clearQuick();
+        index.ensureStorageAllocated(RESERVED_FRAMES);
+
+        DBG("ShowRecorder::open - recording to " + file.getFullPathName());
+        return true;
+    }
+
+    // Write the index, complete the header and close the file
+    void close()
+    {
+        if (stream == nullptr)
+            return;
+
+        flushWriteBuffer();
+
+        // The player reads the index in place, so align it
+        const auto padding = static_cast<size_t>((8 - fileOffset % 8) % 8);
+        stream->writeRepeatedByte(0, padding);
+        fileOffset += padding;
+
+        header.numFrames = static_cast<juce::uint32>(index.size());
+        header.indexOffset = fileOffset;
+        stream->write(index.getRawDataPointer(), static_cast<size_t>(index.size()) * sizeof(ShowFile::IndexEntry));
+
+        stream->setPosition(0);
+        stream->write(&header, sizeof(header));
+        stream->flush();
+        stream.reset();
+
+        DBG("ShowRecorder::close - " + juce::String(index.size()) + " frames, "
+            + juce::String(static_cast<juce::int64>(fileOffset)) + " payload bytes");
+    }
+
+    bool isOpen() const { return stream != nullptr; }
+
+    void writeFrame(juce::int64 time, const uint8_t* data, int numChannels)
+    {
+        if (stream == nullptr)
+            return;
+
+        numChannels = juce::jlimit(0, ShowFile::MAX_CHANNELS, numChannels);
+
+        // Worst case the frame goes raw, so make room for that much
+        if (writePosition + numChannels > WRITE_BUFFER_SIZE)
+            flushWriteBuffer();
+
+        ShowFile::IndexEntry entry;
+        entry.time = time;
+        entry.offset = fileOffset + static_cast<juce::uint64>(writePosition);
+        entry.numChannels = static_cast<juce::uint32>(numChannels);
+
+        int size = -1;
+        if (numChannels == previousChannels && index.size() - keyframe < ShowFile::KEYFRAME_INTERVAL)
+            size = encodeDelta(data, numChannels, writeBuffer + writePosition);
+
+        if (size >= 0)
+        {
+            entry.isDelta = 1;
+        }
+        else
+        {
+            keyframe = index.size();
+            memcpy(writeBuffer + writePosition, data, static_cast<size_t>(numChannels));
+            size = numChannels;
+        }
+
+        entry.size = static_cast<juce::uint32>(size);
+        entry.keyframe = static_cast<juce::uint32>(keyframe);
+        index.add(entry);
+
+        writePosition += size;
+        memcpy(previousFrame, data, static_cast<size_t>(numChannels));
+        previousChannels = numChannels;
+        header.maxChannels = juce::jmax(header.maxChannels, static_cast<juce::uint32>(numChannels));
+    }
+
+private:
+    static constexpr int MIN_SKIP = 4;  // Unchanged stretches shorter than a run header are sent along
+
+    // Runs of changed bytes against previousFrame; -1 if the delta would not be smaller than the raw frame
+    int encodeDelta(const uint8_t* data, int numChannels, uint8_t* dest) const
+    {
+        int size = 0;
+        int position = 0;
+
+        while (position < numChannels)
+        {
+            int start = position;
+            while (start < numChannels && data[start] == previousFrame[start])
+                start++;
+
+            if (start == numChannels)
+                break;
+
+            // Extend the run until MIN_SKIP unchanged bytes in a row (or the end)
+            int end = start + 1;
+            int unchanged = 0;
+            while (end < numChannels && unchanged < MIN_SKIP)
+            {
+                unchanged = data[end] == previousFrame[end] ? unchanged + 1 : 0;
+                end++;
+            }
+            end -= unchanged;
+
+            const int skip = start - position;
+            const int length = end - start;
+            if (size + 4 + length >= numChannels)
+                return -1;
+
+            writeUInt16(dest + size, static_cast<juce::uint16>(skip));
+            writeUInt16(dest + size + 2, static_cast<juce::uint16>(length));
+            memcpy(dest + size + 4, data + start, static_cast<size_t>(length));
+            size += 4 + length;
+            position = end;
+        }
+
+        return size;
+    }
+
+    static void writeUInt16(uint8_t* dest, juce::uint16 value)
+    {
+        dest[0] = static_cast<uint8_t>(value & 0xff);
+        dest[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void flushWriteBuffer()
+    {
+        if (writePosition == 0)
+            return;
+
+        stream->write(writeBuffer, static_cast<size_t>(writePosition));
+        fileOffset += static_cast<juce::uint64>(writePosition);
+        writePosition = 0;
+    }
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    ShowFile::Header header;
+    juce::Array<ShowFile::IndexEntry> index;
+
+    juce::HeapBlock<uint8_t> writeBuffer;
+    int writePosition = 0;
+    juce::uint64 fileOffset = 0;   // File position of writeBuffer[0]
+
+    juce::HeapBlock<uint8_t> previousFrame;
+    int previousChannels = -1;
+    int keyframe = 0;
+};
+
+// Plays a show file straight from a memory mapping
+//
+// The file is never read into memory: raw frames are handed out as pointers into the mapping,
+// so they go to the senders without a copy, and delta frames are applied in one frame buffer.
+// Finding the frame for a time is a binary search over the mapped index; decoding it costs at
+// most KEYFRAME_INTERVAL - 1 deltas, so seeking anywhere in an hour-long show is immediate.
+class ShowPlayer
+{
+public:
+    bool open(const juce::File& file)
+    {
+        close();
+
+        mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        const auto* data = static_cast<const uint8_t*>(mapping->getData());
+        const size_t size = mapping->getSize();
+
+        if (data == nullptr || size < sizeof(ShowFile::Header))
+            return fail("cannot map " + file.getFullPathName());
+
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "KGSH", 4) != 0 || header.version != ShowFile::VERSION)
+            return fail(file.getFileName() + " is not a version " + juce::String(ShowFile::VERSION) + " show file");
+
+        if (header.indexOffset == 0 || header.ticksPerSecond <= 0.0 || header.maxChannels > static_cast<juce::uint32>(ShowFile::MAX_CHANNELS)
+            || header.indexOffset + static_cast<juce::uint64>(header.numFrames) * sizeof(ShowFile::IndexEntry) > size)
+            return fail(file.getFileName() + " has no valid index (recording not finished?)");
+
+        base = data;
+        fileSize = size;
+        entries = reinterpret_cast<const ShowFile::IndexEntry*>(data + header.indexOffset);
+        frameBuffer.calloc(juce::jmax(1u, header.maxChannels));
+        bufferFrame = -1;
+
+        DBG("ShowPlayer::open - " + file.getFileName() + ": " + juce::String(getNumFrames()) + " frames, "
+            + juce::String(getLengthSeconds(), 1) + " s");
+        return true;
+    }
+
+    void close()
+    {
+        mapping.reset();
+        base = nullptr;
+        entries = nullptr;
+        header = ShowFile::Header();
+        bufferFrame = -1;
+    }
+
+    bool isOpen() const { return entries != nullptr; }
+    int getNumFrames() const { return isOpen() ? static_cast<int>(header.numFrames) : 0; }
+    int getMaxChannels() const { return static_cast<int>(header.maxChannels); }
+    double getTicksPerSecond() const { return header.ticksPerSecond; }
+
+    // Recorded time of a frame, in ticks
+    juce::int64 getFrameTime(int frame) const { return entries[frame].time; }
+
+    double getFrameSeconds(int frame) const
+    {
+        return static_cast<double>(entries[frame].time - entries[0].time) / header.ticksPerSecond;
+    }
+
+    double getLengthSeconds() const
+    {
+        return getNumFrames() > 0 ? getFrameSeconds(getNumFrames() - 1) : 0.0;
+    }
+
+    // Last frame at or before seconds from the start of the show (-1 before the first frame)
+    int findFrame(double seconds) const
+    {
+        if (getNumFrames() == 0)
+            return -1;
+
+        const auto time = entries[0].time + static_cast<juce::int64>(seconds * header.ticksPerSecond);
+        const auto* end = entries + header.numFrames;
+        const auto* next = std::upper_bound(entries, end, time,
+                                            [] (juce::int64 t, const ShowFile::IndexEntry& entry) { return t < entry.time; });
+        return static_cast<int>(next - entries) - 1;
+    }
+
+    // Wire bytes of a frame - valid until the next call. Sequential playback decodes one delta per frame
+    const uint8_t* getFrame(int frame, int& numChannels)
+    {
+        numChannels = 0;
+        if (frame < 0 || frame >= getNumFrames())
+            return nullptr;
+
+        const auto& entry = entries[frame];
+        if (!isPayloadValid(entry))
+            return nullptr;
+
+        numChannels = static_cast<int>(entry.numChannels);
+        if (!entry.isDelta)
+            return base + entry.offset;
+
+        if (bufferFrame == frame)
+            return frameBuffer;
+
+        // Bring the buffer to the previous frame (from the keyframe unless it already holds it)
+        if (bufferFrame != frame - 1)
+        {
+            const auto& key = entries[entry.keyframe];
+            if (entry.keyframe >= static_cast<juce::uint32>(frame) || !isPayloadValid(key) || key.isDelta)
+                return nullptr;
+
+            memcpy(frameBuffer, base + key.offset, key.numChannels);
+            for (int f = static_cast<int>(entry.keyframe) + 1; f < frame; f++)
+                applyDelta(entries[f]);
+        }
+
+        applyDelta(entry);
+        bufferFrame = frame;
+        return frameBuffer;
+    }
+
+private:
+    bool fail(const juce::String& reason)
+    {
+        DBG("ShowPlayer::open - " + reason);
+        juce::ignoreUnused(reason);
+        close();
+        return false;
+    }
+
+    bool isPayloadValid(const ShowFile::IndexEntry& entry) const
+    {
+        return entry.numChannels <= header.maxChannels && entry.offset + entry.size <= fileSize;
+    }
+
+    void applyDelta(const ShowFile::IndexEntry& entry)
+    {
+        if (!isPayloadValid(entry))
+            return;
+
+        const uint8_t* run = base + entry.offset;
+        const uint8_t* end = run + entry.size;
+        int position = 0;
+
+        while (run + 4 <= end)
+        {
+            const int skip = run[0] | (run[1] << 8);
+            const int length = run[2] | (run[3] << 8);
+            position += skip;
+            if (run + 4 + length > end || position + length > static_cast<int>(entry.numChannels))
+                break;
+
+            memcpy(frameBuffer + position, run + 4, static_cast<size_t>(length));
+            position += length;
+            run += 4 + length;
+        }
+    }
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    const uint8_t* base = nullptr;
+    size_t fileSize = 0;
+    ShowFile::Header header;
+    const ShowFile::IndexEntry* entries = nullptr;
+
+    juce::HeapBlock<uint8_t> frameBuffer;
+    int bufferFrame = -1;  // Frame currently decoded in frameBuffer
+};
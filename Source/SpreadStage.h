@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    SpreadStage.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Falloff shape of the glow around a lit key
+enum class SpreadMode
+{
+    Off = 0,
+    Gaussian,
+    Exponential
+};
+
+// Spatial glow along the strip
+//
+// Voices render impulses (their lit span, scaled by glow intensity) into a separate RGB
+// buffer. process() blurs that buffer once per frame and adds it to the compositor frame,
+// so the cost is O(pixels) no matter how many notes are held or how wide the radius is:
+//   Gaussian    - three box blurs (running sums), which converge on a Gaussian
+//   Exponential - first-order IIR run forwards and backwards along the strip
+// Both kernels are normalised to a peak of 1, so a single lit LED keeps its brightness
+// and the neighbours fade out from there.
+class SpreadStage
+{
+public:
+    // Allocate buffers (call from prepareToPlay - never on the audio thread)
+    void prepare(int numPixels)
+    {
+        if (numPixels <= maxPixels)
+            return;
+
+        maxPixels = numPixels;
+        impulses.calloc(static_cast<size_t>(maxPixels) * 3);
+        scratch.calloc(static_cast<size_t>(maxPixels) * 3);
+        prefix.calloc(static_cast<size_t>(maxPixels + 1) * 3);
+    }
+
+    // radius = distance in LEDs at which the glow has fallen to about 5%
+    void setShape(SpreadMode newMode, float radiusLEDs, float newAmount)
+    {
+        mode = newMode;
+        amount = newAmount;
+
+        if (radiusLEDs == radius)
+            return;
+
+        radius = radiusLEDs;
+
+        // Gaussian: exp(-x^2 / 2 sigma^2) = 0.05 at x = 2.45 sigma
+        // Three boxes of width w give sigma^2 = 3 (w^2 - 1) / 12
+        const float sigma = juce::jmax(0.3f, radius / 2.45f);
+        boxRadius = juce::jmax(0, juce::roundToInt((std::sqrt(4.0f * sigma * sigma + 1.0f) - 1.0f) * 0.5f));
+
+        // Exponential: pole^radius = 0.05
+        pole = std::pow(0.05f, 1.0f / juce::jmax(0.5f, radius));
+    }
+
+    bool isActive() const { return mode != SpreadMode::Off && amount > 0.0f; }
+
+    void clear(int numPixels)
+    {
+        juce::FloatVectorOperations::clear(impulses.get(), juce::jmin(numPixels, maxPixels) * 3);
+    }
+
+    // Additively blend a colour into a pixel span, clipped to the buffer (same contract as Layer::addSpan)
+    void addImpulse(int firstPixel, int numPixels, float red, float green, float blue)
+    {
+        const int first = juce::jmax(0, firstPixel);
+        const int last = juce::jmin(maxPixels, firstPixel + numPixels);
+
+        for (int pixel = first; pixel < last; pixel++)
+        {
+            float* rgb = impulses.get() + pixel * 3;
+            rgb[0] += red;
+            rgb[1] += green;
+            rgb[2] += blue;
+        }
+    }
+
+    // Blur the impulses within [firstPixel, firstPixel + numPixels) and add them to rgbFrame
+    // Glow that would spread past either end of the range is dropped
+    void process(float* rgbFrame, int firstPixel, int numPixels)
+    {
+        if (!isActive() || firstPixel < 0 || numPixels <= 0 || firstPixel + numPixels > maxPixels)
+            return;
+
+        float* source = impulses.get() + firstPixel * 3;
+        float* dest = rgbFrame + firstPixel * 3;
+        const int numValues = numPixels * 3;
+
+        if (mode == SpreadMode::Gaussian)
+        {
+            // Peak of three unit-area boxes of width w is about 1 / (sigma * sqrt(2 pi))
+            const int width = boxRadius * 2 + 1;
+            const float sigma = std::sqrt(static_cast<float>(width * width - 1) * 0.25f);
+            const float peakGain = juce::jmax(1.0f, sigma * std::sqrt(2.0f * juce::MathConstants<float>::pi));
+
+            boxBlur(source, scratch.get(), numPixels);
+            boxBlur(scratch.get(), source, numPixels);
+            boxBlur(source, scratch.get(), numPixels);
+
+            juce::FloatVectorOperations::addWithMultiply(dest, scratch.get(), amount * peakGain, numValues);
+        }
+        else
+        {
+            exponentialBlur(source, scratch.get(), numPixels);
+            juce::FloatVectorOperations::addWithMultiply(dest, scratch.get(), amount, numValues);
+        }
+    }
+
+private:
+    // Box blur of interleaved RGB via running sums - out[i] = mean(in[i - r .. i + r])
+    void boxBlur(const float* in, float* out, int numPixels)
+    {
+        const int r = boxRadius;
+        float* sums = prefix.get();
+
+        // sums[i] = in[0] + ... + in[i - 1] per channel
+        sums[0] = sums[1] = sums[2] = 0.0f;
+        for (int i = 0; i < numPixels * 3; i++)
+            sums[i + 3] = sums[i] + in[i];
+
+        const float scale = 1.0f / static_cast<float>(r * 2 + 1);
+
+        // Interior: a window difference of the running sums, fully vectorised
+        const int interior = numPixels - 2 * r;
+        if (interior > 0)
+        {
+            juce::FloatVectorOperations::subtract(out + r * 3, sums + (2 * r + 1) * 3, sums, interior * 3);
+            juce::FloatVectorOperations::multiply(out + r * 3, scale, interior * 3);
+        }
+
+        // Edges: the window reaches past the end of the strip, which counts as dark
+        for (int pixel = 0; pixel < numPixels; pixel++)
+        {
+            if (pixel == r && interior > 0)
+                pixel = r + interior;
+
+            if (pixel >= numPixels)
+                break;
+
+            const int lo = juce::jmax(0, pixel - r);
+            const int hi = juce::jmin(numPixels, pixel + r + 1);
+
+            for (int channel = 0; channel < 3; channel++)
+                out[pixel * 3 + channel] = (sums[hi * 3 + channel] - sums[lo * 3 + channel]) * scale;
+        }
+    }
+
+    // Symmetric exponential falloff: forward and backward one-pole passes, centre counted once
+    void exponentialBlur(const float* in, float* out, int numPixels)
+    {
+        float* backward = prefix.get();
+        const int numValues = numPixels * 3;
+
+        float state[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < numValues; i += 3)
+        {
+            for (int channel = 0; channel < 3; channel++)
+                out[i + channel] = state[channel] = in[i + channel] + pole * state[channel];
+        }
+
+        state[0] = state[1] = state[2] = 0.0f;
+        for (int i = numValues - 3; i >= 0; i -= 3)
+        {
+            for (int channel = 0; channel < 3; channel++)
+                backward[i + channel] = state[channel] = in[i + channel] + pole * state[channel];
+        }
+
+        juce::FloatVectorOperations::add(out, backward, numValues);
+        juce::FloatVectorOperations::subtract(out, in, numValues);
+    }
+
+    juce::HeapBlock<float> impulses;
+    juce::HeapBlock<float> scratch;
+    juce::HeapBlock<float> prefix;
+    int maxPixels = 0;
+
+    SpreadMode mode = SpreadMode::Off;
+    float radius = -1.0f;
+    float amount = 0.0f;
+    int boxRadius = 0;
+    float pole = 0.0f;
+};
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 2025
+    Author: KeyGlow Project
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lock-free single-producer / single-consumer triple buffer
+//
+// The writer fills getWriteBuffer() and calls publish(); the reader calls update() and then
+// reads getReadBuffer(). Neither side ever blocks or allocates, and the reader always sees the
+// most recently published complete value (intermediate values may be skipped).
+// Typical use: tables built on the message thread and consumed on the audio thread.
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    // Writer side ------------------------------------------------------------
+    Type& getWriteBuffer() { return buffers[writeIndex]; }
+
+    void publish()
+    {
+        // Hand the written slot over as the middle slot and take the previous middle slot back
+        const int previous = middle.exchange(writeIndex | NEW_DATA_FLAG, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side ------------------------------------------------------------
+    // Returns true if a new value was published since the last call
+    bool update()
+    {
+        if ((middle.load(std::memory_order_relaxed) & NEW_DATA_FLAG) == 0)
+            return false;
+
+        const int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const Type& getReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int NEW_DATA_FLAG = 4;
+
+    Type buffers[3] {};
+    int writeIndex = 0;                  // Owned by the writer
+    int readIndex = 1;                   // Owned by the reader
+    std::atomic<int> middle { 2 };       // Shared slot index + new data flag
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
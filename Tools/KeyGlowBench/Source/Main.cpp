@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 2025
+    Author: KeyGlow Project
+
+    KeyGlowBench: times the output stage of the frame pipeline (FrameCompositor
+    and the PixelKernels quantiser) on frames far larger than the plugin sends.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "FrameCompositor.h"
+
+namespace
+{
+    struct BenchSettings
+    {
+        int numPixels = 10240;   // The plugin stops at SegmentMap::MAX_PIXELS (1024); this is a stress size
+        int numFrames = 2000;
+        int numSourceFrames = 8; // Distinct input frames, cycled so the LUT reads do not settle on one pattern
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: KeyGlowBench [options]\n"
+                  << "  --pixels=<n>          Pixels per frame (default 10240)\n"
+                  << "  --frames=<n>          Frames per measurement (default 2000)\n";
+    }
+
+    // Fixed-point RGB frames like the LayerStack produces: mostly dark, some mid levels, a few at full
+    juce::HeapBlock<uint16_t> makeSourceFrames(const BenchSettings& settings)
+    {
+        const size_t frameChannels = static_cast<size_t>(settings.numPixels) * 3;
+        juce::HeapBlock<uint16_t> frames(frameChannels * static_cast<size_t>(settings.numSourceFrames));
+        juce::Random random(0x4b47);
+
+        for (size_t i = 0; i < frameChannels * static_cast<size_t>(settings.numSourceFrames); i++)
+        {
+            const int kind = random.nextInt(8);
+            frames[i] = static_cast<uint16_t>(kind < 4 ? random.nextInt(2048)
+                                            : kind < 7 ? random.nextInt(65536)
+                                                       : 65535);
+        }
+
+        return frames;
+    }
+
+    void printResult(const char* name, double seconds, int numFrames, int numPixels, juce::uint32 checksum)
+    {
+        const double perFrameUs = seconds * 1.0e6 / numFrames;
+        const double perPixelNs = perFrameUs * 1000.0 / numPixels;
+
+        std::cout << juce::String(name).paddedRight(' ', 28)
+                  << juce::String(perFrameUs, 1).paddedLeft(' ', 9) << " us/frame"
+                  << juce::String(perPixelNs, 2).paddedLeft(' ', 8) << " ns/pixel"
+                  << juce::String(1.0 / (seconds / numFrames), 0).paddedLeft(' ', 10) << " frames/s"
+                  << "   (" << juce::String::toHexString(static_cast<int>(checksum)) << ")\n";
+    }
+
+    // FrameCompositor::render: index conversion, LUT packing in wire order, limiter and quantiser
+    void benchRender(const BenchSettings& settings, const uint16_t* sourceFrames, const char* name,
+                     ColourOrder order, bool dither, float brightness)
+    {
+        FrameCompositor compositor;
+        compositor.prepare(settings.numPixels);
+        compositor.setColourOrder(order);
+        compositor.setDithering(dither);
+        compositor.setBrightness(brightness);
+
+        juce::HeapBlock<uint8_t> wire(static_cast<size_t>(settings.numPixels) * 4);
+        const size_t frameChannels = static_cast<size_t>(settings.numPixels) * 3;
+        juce::uint32 checksum = 0;
+
+        // One untimed pass warms the caches and the dither state
+        compositor.render(sourceFrames, wire, settings.numPixels);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int frame = 0; frame < settings.numFrames; frame++)
+        {
+            const uint16_t* source = sourceFrames + frameChannels * static_cast<size_t>(frame % settings.numSourceFrames);
+            const int numChannels = compositor.render(source, wire, settings.numPixels);
+            checksum += wire[frame % numChannels];
+        }
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        printResult(name, seconds, settings.numFrames, settings.numPixels, checksum);
+    }
+
+    // PixelKernels::quantiseTo8Bit on its own (RGB, 3 channels per pixel)
+    template <bool dither>
+    void benchQuantise(const BenchSettings& settings, const uint16_t* sourceFrames, const char* name, int scaleQ16)
+    {
+        const int numChannels = settings.numPixels * 3;
+        juce::HeapBlock<uint16_t> linear(static_cast<size_t>(numChannels) * static_cast<size_t>(settings.numSourceFrames));
+        juce::HeapBlock<uint16_t> error(static_cast<size_t>(numChannels), true);
+        juce::HeapBlock<uint8_t> wire(static_cast<size_t>(numChannels));
+        juce::uint32 checksum = 0;
+
+        // The quantiser expects linear values up to LINEAR_MAX
+        for (size_t i = 0; i < static_cast<size_t>(numChannels) * static_cast<size_t>(settings.numSourceFrames); i++)
+            linear[i] = static_cast<uint16_t>((static_cast<juce::uint32>(sourceFrames[i]) * PixelKernels::LINEAR_MAX) / 65535);
+
+        PixelKernels::quantiseTo8Bit<dither>(linear, error, wire, numChannels, scaleQ16);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int frame = 0; frame < settings.numFrames; frame++)
+        {
+            const uint16_t* source = linear + static_cast<size_t>(numChannels) * static_cast<size_t>(frame % settings.numSourceFrames);
+            PixelKernels::quantiseTo8Bit<dither>(source, error, wire, numChannels, scaleQ16);
+            checksum += wire[frame % numChannels];
+        }
+        const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        printResult(name, seconds, settings.numFrames, settings.numPixels, checksum);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    BenchSettings settings;
+    if (args.containsOption("--pixels"))
+        settings.numPixels = juce::jlimit(1, 1 << 20, args.getValueForOption("--pixels").getIntValue());
+    if (args.containsOption("--frames"))
+        settings.numFrames = juce::jmax(1, args.getValueForOption("--frames").getIntValue());
+
+   #if KEYGLOW_SIMD_AVX2
+    const char* kernels = "AVX2";
+   #elif KEYGLOW_SIMD_SSE2
+    const char* kernels = "SSE2";
+   #elif KEYGLOW_SIMD_NEON
+    const char* kernels = "NEON";
+   #else
+    const char* kernels = "scalar";
+   #endif
+
+    std::cout << settings.numPixels << " pixels, " << settings.numFrames << " frames, " << kernels << " kernels\n";
+
+    const auto sourceFrames = makeSourceFrames(settings);
+
+    benchRender(settings, sourceFrames, "render RGB dither",        ColourOrder::RGB,  true,  1.0f);
+    benchRender(settings, sourceFrames, "render RGB no dither",     ColourOrder::RGB,  false, 1.0f);
+    benchRender(settings, sourceFrames, "render RGB dither 50%",    ColourOrder::RGB,  true,  0.5f);
+    benchRender(settings, sourceFrames, "render GRB dither",        ColourOrder::GRB,  true,  1.0f);
+    benchRender(settings, sourceFrames, "render RGBW dither",       ColourOrder::RGBW, true,  1.0f);
+
+    benchQuantise<true>(settings, sourceFrames,  "quantiseTo8Bit dither",     65536);
+    benchQuantise<false>(settings, sourceFrames, "quantiseTo8Bit no dither",  65536);
+    benchQuantise<true>(settings, sourceFrames,  "quantiseTo8Bit dither 50%", 32768);
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 2025
+    Author: KeyGlow Project
+
+    KeyGlowDaemon: headless KeyGlow for permanent installations.
+    MIDI in, LEDs out - no editor, no audio device, no message loop.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <csignal>
+#include "PluginProcessor.h"
+
+namespace
+{
+    std::atomic<bool> quitRequested { false };
+    std::atomic<bool> reloadRequested { false };
+
+    void handleSignal(int signal)
+    {
+        if (signal == SIGHUP)
+            reloadRequested = true;
+        else
+            quitRequested = true;
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: KeyGlowDaemon <config.xml> [options]\n"
+                  << "  --midi=<name>         Only open MIDI inputs whose name contains this (default: all)\n"
+                  << "  --sample-rate=<hz>    Engine clock (default 48000)\n"
+                  << "  --block=<samples>     Engine block size (default 256)\n"
+                  << "  --write-config=<file> Write the default configuration and exit\n"
+                  << "The configuration is the plugin state as XML. SIGHUP reloads it, SIGINT/SIGTERM stop the daemon.\n";
+    }
+
+    bool loadConfig(KeyGlowAudioProcessor& processor, const juce::File& file)
+    {
+        auto xml = juce::parseXML(file);
+        auto& state = processor.getValueTreeState();
+        if (xml == nullptr || !xml->hasTagName(state.state.getType()))
+        {
+            std::cerr << "Cannot read configuration " << file.getFullPathName() << "\n";
+            return false;
+        }
+
+        state.replaceState(juce::ValueTree::fromXml(*xml));
+        return true;
+    }
+
+    // Drives the processor in place of an audio device: one block of silence per block period,
+    // with the MIDI that arrived meanwhile. Table rebuilds run here too, as there is no message loop,
+    // and so do config reloads: the plugin state (a ValueTree) is read on every block, so it may
+    // only be replaced between blocks on this thread.
+    class RenderThread : public juce::Thread
+    {
+    public:
+        RenderThread(KeyGlowAudioProcessor& processorToUse, juce::MidiMessageCollector& midiCollector,
+                     const juce::File& config, double rate, int samplesPerBlock)
+            : juce::Thread("KeyGlow Render"),
+              processor(processorToUse),
+              collector(midiCollector),
+              configFile(config),
+              sampleRate(rate),
+              blockSize(samplesPerBlock),
+              buffer(juce::jmax(1, processorToUse.getTotalNumInputChannels(), processorToUse.getTotalNumOutputChannels()), samplesPerBlock)
+        {
+            midi.ensureSize(4096);
+        }
+
+        ~RenderThread() override
+        {
+            stopThread(2000);
+        }
+
+        // Realtime scheduling where the system allows it (rtprio), a normal thread otherwise
+        void start()
+        {
+            const double periodMs = blockSize * 1000.0 / sampleRate;
+            if (!startRealtimeThread(juce::Thread::RealtimeOptions().withPriority(8).withPeriodMs(periodMs)))
+            {
+                std::cerr << "Realtime scheduling not permitted (check rtprio in /etc/security/limits.conf), running at normal priority\n";
+                startThread(juce::Thread::Priority::highest);
+            }
+        }
+
+        void run() override
+        {
+            const double periodMs = blockSize * 1000.0 / sampleRate;
+            double nextBlockMs = juce::Time::getMillisecondCounterHiRes();
+
+            while (!threadShouldExit())
+            {
+                collector.removeNextBlockOfMessages(midi, blockSize);
+
+                buffer.clear();
+                processor.processBlock(buffer, midi);
+                midi.clear();
+
+                if (reloadRequested.exchange(false) && loadConfig(processor, configFile))
+                    std::cout << "Reloaded " << configFile.getFullPathName() << "\n";
+
+                processor.rebuildPendingTables();
+
+                // Keep the block clock on the wall clock; after a stall skip ahead instead of catching up
+                nextBlockMs += periodMs;
+                const double nowMs = juce::Time::getMillisecondCounterHiRes();
+                if (nextBlockMs < nowMs - periodMs * 4.0)
+                    nextBlockMs = nowMs;
+
+                const int waitMs = static_cast<int>(nextBlockMs - nowMs);
+                if (waitMs > 0)
+                    wait(waitMs);
+            }
+        }
+
+    private:
+        KeyGlowAudioProcessor& processor;
+        juce::MidiMessageCollector& collector;
+        const juce::File configFile;
+        const double sampleRate;
+        const int blockSize;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--write-config"))
+    {
+        KeyGlowAudioProcessor processor;
+        const juce::File file = args.getFileForOption("--write-config");
+        auto xml = processor.getValueTreeState().copyState().createXml();
+        if (xml == nullptr || !xml->writeTo(file))
+        {
+            std::cerr << "Cannot write " << file.getFullPathName() << "\n";
+            return 1;
+        }
+
+        std::cout << "Wrote " << file.getFullPathName() << "\n";
+        return 0;
+    }
+
+    if (args.size() < 1 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return args.containsOption("--help|-h") ? 0 : 1;
+    }
+
+    const juce::File configFile = args[0].resolveAsFile();
+    const double sampleRate = args.containsOption("--sample-rate")
+                                ? juce::jlimit(8000.0, 192000.0, args.getValueForOption("--sample-rate").getDoubleValue()) : 48000.0;
+    const int blockSize = args.containsOption("--block")
+                            ? juce::jlimit(32, 4096, args.getValueForOption("--block").getIntValue()) : 256;
+
+    KeyGlowAudioProcessor processor;
+    if (!loadConfig(processor, configFile))
+        return 1;
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    processor.rebuildPendingTables();
+
+    // MIDI inputs feed the collector, which places each message in its block by arrival time
+    juce::MidiMessageCollector collector;
+    collector.reset(sampleRate);
+
+    const juce::String deviceFilter = args.getValueForOption("--midi");
+    std::vector<std::unique_ptr<juce::MidiInput>> inputs;
+    for (const auto& device : juce::MidiInput::getAvailableDevices())
+    {
+        if (deviceFilter.isNotEmpty() && !device.name.containsIgnoreCase(deviceFilter))
+            continue;
+
+        if (auto input = juce::MidiInput::openDevice(device.identifier, &collector))
+        {
+            input->start();
+            std::cout << "MIDI input: " << device.name << "\n";
+            inputs.push_back(std::move(input));
+        }
+    }
+
+    if (inputs.empty())
+        std::cerr << "No MIDI input" << (deviceFilter.isNotEmpty() ? " matching '" + deviceFilter + "'" : juce::String()) << " - running the idle animation only\n";
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGHUP, handleSignal);
+
+    RenderThread renderThread(processor, collector, configFile, sampleRate, blockSize);
+    renderThread.start();
+    std::cout << "KeyGlowDaemon running (" << juce::String(blockSize * 1000.0 / sampleRate, 1) << " ms blocks)\n";
+
+    // SIGHUP reloads are picked up by the render thread between blocks
+    while (!quitRequested)
+        juce::Thread::sleep(100);
+
+    for (auto& input : inputs)
+        input->stop();
+
+    renderThread.stopThread(2000);
+    processor.releaseResources();
+    std::cout << "KeyGlowDaemon stopped\n";
+    return 0;
+}
@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 2025
+    Author: KeyGlow Project
+
+    KeyGlowRender: renders a MIDI file to a KeyGlow show file without a DAW,
+    using the plugin's own processor as the render engine.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "PluginProcessor.h"
+#include "FseqFile.h"
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::File midiFile;
+        juce::File outputFile;
+        juce::File presetFile;       // Plugin state (XML), optional
+        int frameRate = 30;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int numThreads = 1;
+        double chunkSeconds = 30.0;
+        double prerollSeconds = 5.0; // Rendered and discarded before each chunk so envelopes and effects are settled
+        bool compressFseq = true;
+    };
+
+    // One time slice of the song, rendered by its own processor into a temporary show file
+    struct Chunk
+    {
+        double start = 0.0;
+        double end = 0.0;
+        juce::File file;
+        bool rendered = false;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: KeyGlowRender <input.mid> <output" << ShowFile::FILE_EXTENSION << "|" << FseqFile::FILE_EXTENSION << "> [options]\n"
+                  << "  --preset=<file>       Plugin state to render with (XML)\n"
+                  << "  --fps=<n>             LED frames per second (default 30)\n"
+                  << "  --threads=<n>         Worker threads (default: all cores)\n"
+                  << "  --chunk=<seconds>     Length of the slices rendered in parallel (default 30)\n"
+                  << "  --sample-rate=<hz>    Engine sample rate (default 48000)\n"
+                  << "  --block=<samples>     Engine block size (default 512)\n"
+                  << "  --uncompressed        Write fseq frames without zlib compression\n";
+    }
+
+    void setParameter(juce::AudioProcessorValueTreeState& state, const char* parameterID, float value)
+    {
+        if (auto* parameter = state.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Controllers and held notes at a point in the song, so a chunk starts where the song is
+    juce::MidiBuffer createStateAt(const juce::MidiMessageSequence& sequence, double time)
+    {
+        juce::MidiBuffer state;
+
+        for (int channel = 1; channel <= 16; channel++)
+        {
+            juce::Array<juce::MidiMessage> controllers;
+            sequence.createControllerUpdatesForTime(channel, time, controllers);
+            for (const auto& message : controllers)
+                state.addEvent(message, 0);
+        }
+
+        for (int i = 0; i < sequence.getNumEvents(); i++)
+        {
+            const auto& message = sequence.getEventPointer(i)->message;
+            if (message.getTimeStamp() >= time)
+                break;
+
+            if (message.isNoteOn() && sequence.getTimeOfMatchingKeyUp(i) > time)
+                state.addEvent(message, 0);
+        }
+
+        return state;
+    }
+
+    void renderChunk(const RenderSettings& settings, const juce::MidiMessageSequence& sequence, Chunk& chunk)
+    {
+        KeyGlowAudioProcessor processor;
+        auto& state = processor.getValueTreeState();
+
+        if (settings.presetFile != juce::File())
+            if (auto xml = juce::parseXML(settings.presetFile))
+                state.replaceState(juce::ValueTree::fromXml(*xml));
+
+        // The bounce path records every frame with its sample time
+        setParameter(state, KeyGlowAudioProcessor::PARAM_FRAME_RATE, static_cast<float>(settings.frameRate));
+        setParameter(state, KeyGlowAudioProcessor::PARAM_SHOW_MODE, 0.0f);
+        state.state.setProperty(KeyGlowAudioProcessor::PARAM_BOUNCE_FILE, chunk.file.getFullPathName(), nullptr);
+
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(settings.sampleRate, settings.blockSize);
+        processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+        processor.rebuildPendingTables();
+
+        juce::AudioBuffer<float> buffer(juce::jmax(1, processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels()),
+                                        settings.blockSize);
+        const double renderStart = juce::jmax(0.0, chunk.start - settings.prerollSeconds);
+        juce::MidiBuffer midi = createStateAt(sequence, renderStart);
+
+        const auto startSample = static_cast<juce::int64>(std::llround(renderStart * settings.sampleRate));
+        const auto endSample = static_cast<juce::int64>(std::ceil(chunk.end * settings.sampleRate));
+        int nextEvent = sequence.getNextIndexAtTime(renderStart);
+
+        for (juce::int64 blockStart = startSample; blockStart < endSample; blockStart += settings.blockSize)
+        {
+            const double blockEnd = static_cast<double>(blockStart + settings.blockSize) / settings.sampleRate;
+
+            for (; nextEvent < sequence.getNumEvents(); nextEvent++)
+            {
+                const auto& message = sequence.getEventPointer(nextEvent)->message;
+                if (message.getTimeStamp() >= blockEnd)
+                    break;
+
+                const auto offset = static_cast<juce::int64>(message.getTimeStamp() * settings.sampleRate) - blockStart;
+                midi.addEvent(message, static_cast<int>(juce::jlimit<juce::int64>(0, settings.blockSize - 1, offset)));
+            }
+
+            buffer.clear();
+            processor.processBlock(buffer, midi);
+            processor.rebuildPendingTables();
+            midi.clear();
+        }
+
+        processor.releaseResources();
+        chunk.rendered = chunk.file.existsAsFile();
+    }
+
+    // Append the frames a chunk owns (its pre-roll belongs to the previous chunk) to the output
+    int appendChunk(const RenderSettings& settings, const Chunk& chunk, ShowRecorder& output)
+    {
+        ShowPlayer player;
+        if (!player.open(chunk.file))
+            return 0;
+
+        const double renderStart = juce::jmax(0.0, chunk.start - settings.prerollSeconds);
+        const auto renderStartSample = static_cast<juce::int64>(std::llround(renderStart * settings.sampleRate));
+        const auto firstSample = static_cast<juce::int64>(std::llround(chunk.start * settings.sampleRate));
+        const auto endSample = static_cast<juce::int64>(std::llround(chunk.end * settings.sampleRate));
+
+        int numFrames = 0;
+        for (int frame = 0; frame < player.getNumFrames(); frame++)
+        {
+            const juce::int64 time = renderStartSample + player.getFrameTime(frame);
+            if (time < firstSample || time >= endSample)
+                continue;
+
+            int numChannels = 0;
+            if (const uint8_t* data = player.getFrame(frame, numChannels))
+            {
+                output.writeFrame(time, data, numChannels);
+                numFrames++;
+            }
+        }
+
+        return numFrames;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() < 2 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return args.containsOption("--help|-h") ? 0 : 1;
+    }
+
+    RenderSettings settings;
+    settings.midiFile = args[0].resolveAsFile();
+    settings.outputFile = args[1].resolveAsFile();
+    if (args.containsOption("--preset"))
+        settings.presetFile = args.getFileForOption("--preset");
+
+    settings.numThreads = juce::SystemStats::getNumCpus();
+    if (args.containsOption("--fps"))
+        settings.frameRate = juce::jlimit(10, 120, args.getValueForOption("--fps").getIntValue());
+    if (args.containsOption("--threads"))
+        settings.numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+    if (args.containsOption("--chunk"))
+        settings.chunkSeconds = juce::jmax(1.0, args.getValueForOption("--chunk").getDoubleValue());
+    if (args.containsOption("--sample-rate"))
+        settings.sampleRate = juce::jlimit(8000.0, 192000.0, args.getValueForOption("--sample-rate").getDoubleValue());
+    if (args.containsOption("--block"))
+        settings.blockSize = juce::jlimit(32, 8192, args.getValueForOption("--block").getIntValue());
+    settings.compressFseq = !args.containsOption("--uncompressed");
+
+    // Read the MIDI file into one sequence, timestamps in seconds
+    juce::MidiFile midiFile;
+    {
+        juce::FileInputStream stream(settings.midiFile);
+        if (!stream.openedOk() || !midiFile.readFrom(stream))
+        {
+            std::cerr << "Cannot read MIDI file " << settings.midiFile.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    juce::MidiMessageSequence sequence;
+    for (int track = 0; track < midiFile.getNumTracks(); track++)
+        sequence.addSequence(*midiFile.getTrack(track), 0.0);
+    sequence.updateMatchedPairs();
+
+    // A little tail so the last releases and effects fade out
+    const double length = sequence.getEndTime() + 2.0;
+
+    // Slice the song; every slice is rendered by its own processor on the thread pool.
+    // Temporary files are named up front (none exist yet), so the names must be unique by construction
+    juce::OwnedArray<Chunk> chunks;
+    const juce::File tempFolder = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    const juce::String tempName = "KeyGlowRender-" + juce::Uuid().toString();
+    for (double start = 0.0; start < length; start += settings.chunkSeconds)
+    {
+        auto* chunk = chunks.add(new Chunk());
+        chunk->start = start;
+        chunk->end = juce::jmin(length, start + settings.chunkSeconds);
+        chunk->file = tempFolder.getChildFile(tempName + "-" + juce::String(chunks.size() - 1) + ShowFile::FILE_EXTENSION);
+    }
+
+    std::cout << "Rendering " << settings.midiFile.getFileName() << " (" << juce::String(length, 1) << " s) at "
+              << settings.frameRate << " fps: " << chunks.size() << " chunk(s) on " << settings.numThreads << " thread(s)\n";
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    {
+        juce::ThreadPool pool(settings.numThreads);
+        for (auto* chunk : chunks)
+            pool.addJob([&settings, &sequence, chunk] { renderChunk(settings, sequence, *chunk); });
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(20);
+    }
+
+    // Stitch the chunks together in order (fseq: into a show file first, then resampled to fixed steps)
+    const bool writeFseq = settings.outputFile.hasFileExtension(FseqFile::FILE_EXTENSION);
+    const juce::File showFile = writeFseq ? tempFolder.getChildFile(tempName + ShowFile::FILE_EXTENSION)
+                                          : settings.outputFile;
+
+    ShowRecorder output;
+    if (!output.open(showFile, settings.sampleRate))
+    {
+        std::cerr << "Cannot write " << settings.outputFile.getFullPathName() << "\n";
+        return 1;
+    }
+
+    int numFrames = 0;
+    bool complete = true;
+    for (auto* chunk : chunks)
+    {
+        complete = complete && chunk->rendered;
+        numFrames += appendChunk(settings, *chunk, output);
+        chunk->file.deleteFile();
+    }
+
+    output.close();
+
+    if (writeFseq)
+    {
+        ShowPlayer show;
+        const int stepTimeMs = juce::roundToInt(1000.0 / settings.frameRate);
+        const auto compression = settings.compressFseq ? FseqFile::Compression::Zlib : FseqFile::Compression::None;
+
+        if (!show.open(showFile) || !FseqWriter::writeShow(show, settings.outputFile, stepTimeMs, compression))
+        {
+            std::cerr << "Cannot write " << settings.outputFile.getFullPathName() << "\n";
+            complete = false;
+        }
+
+        show.close();
+        showFile.deleteFile();
+    }
+
+    const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    std::cout << numFrames << " frames in " << juce::String(seconds, 2) << " s: "
+              << juce::String(numFrames / juce::jmax(0.001, seconds), 1) << " frames/s, "
+              << juce::String(length / juce::jmax(0.001, seconds), 1) << "x real time\n"
+              << "Wrote " << settings.outputFile.getFullPathName() << "\n";
+
+    if (!complete)
+        std::cerr << "Some chunks failed to render\n";
+
+    return complete ? 0 : 1;
+}